@@ -1,4 +1,5 @@
 #include "commsInterface.h"
+#include "packetLayout.h"
 
 CommsInterface::CommsInterface() {
     // Constructor implementation
@@ -14,3 +15,7 @@ void CommsInterface::DMA_write(uint8_t *data, uint16_t len) {}
 void CommsInterface::DMA_read(uint8_t *data, uint16_t len) {}
 void CommsInterface::flag_new_data(void) {}
 
+bool CommsInterface::unpackRx(const uint8_t* data, uint16_t length) { return packetLayout.unpackRx(data, length, *ptrRxData); }
+uint16_t CommsInterface::packTx(uint8_t* data) { return packetLayout.packTx(*ptrTxData, data); }
+uint16_t CommsInterface::writeLayoutDescriptor(uint8_t* data) { return packetLayout.writeDescriptor(data); }
+
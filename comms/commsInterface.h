@@ -26,6 +26,13 @@ public:
 	virtual void DMA_read(uint8_t*, uint16_t);
 	virtual void flag_new_data(void);
 
+	// Packet copies through the negotiated packet layout, for the transports.
+	// A transport receives into its own buffer and calls unpackRx(), flagging
+	// new data only when it returns true, then sends what packTx() builds.
+	bool unpackRx(const uint8_t* data, uint16_t length);
+	uint16_t packTx(uint8_t* data);
+	uint16_t writeLayoutDescriptor(uint8_t* data);
+
     void setDataCallback(const std::function<void(bool)>& callback) {
         dataCallback = callback;
     }
@@ -0,0 +1,101 @@
+#include "packetLayout.h"
+
+#include <cstring>
+
+static_assert(Config::variables <= 32, "the layout descriptor holds at most 32 variables");
+static_assert(4 + 4 * Config::joints + 4 * Config::variables + sizeof(jointMask_t) + 2 <= Config::dataBuffSize, "rxData_t channels do not fit in Config::dataBuffSize");
+static_assert(4 + 4 * Config::joints + 4 * Config::variables + 2 <= Config::dataBuffSize, "txData_t channels do not fit in Config::dataBuffSize");
+static_assert(offsetof(rxData_t, setPoint) == 4 + 4 * Config::joints && offsetof(txData_t, processVariable) == 4 + 4 * Config::joints,
+              "rxData_t and txData_t must match the full packet layout");
+
+PacketLayout::PacketLayout()
+    : joints(Config::joints),
+      setPoints(Config::variables),
+      processVariables(Config::variables)
+{
+    storage = computeOffsets(Config::joints, Config::variables, Config::variables);
+    packet = storage;
+}
+
+PacketLayout::Offsets PacketLayout::computeOffsets(uint32_t joints, uint32_t setPoints, uint32_t processVariables)
+{
+    Offsets offsets;
+    offsets.rxSetPoint = 4 + 4 * joints;
+    offsets.rxJointEnable = offsets.rxSetPoint + 4 * setPoints;
+    offsets.rxOutputs = offsets.rxJointEnable + sizeof(jointMask_t);
+    offsets.rxSize = (offsets.rxOutputs + 2 + 3) & ~3;
+
+    offsets.txProcessVariable = 4 + 4 * joints;
+    offsets.txInputs = offsets.txProcessVariable + 4 * processVariables;
+    offsets.txSize = (offsets.txInputs + 2 + 3) & ~3;
+    return offsets;
+}
+
+bool PacketLayout::configure(uint32_t _joints, uint32_t _setPoints, uint32_t _processVariables)
+{
+    if (_joints > Config::joints || _setPoints > Config::variables || _processVariables > Config::variables) {
+        return false;
+    }
+
+    joints = _joints;
+    setPoints = _setPoints;
+    processVariables = _processVariables;
+    packet = computeOffsets(joints, setPoints, processVariables);
+    full = (joints == Config::joints && setPoints == Config::variables && processVariables == Config::variables);
+    return true;
+}
+
+bool PacketLayout::unpackRx(const uint8_t* data, uint16_t length, volatile rxData_t& rx) const
+{
+    uint8_t* buffer = (uint8_t*)rx.rxBuffer;
+
+    if (full) {
+        // the fixed layout, longer packets from older hosts are cut to rxData
+        if (length < packet.rxSize) return false;
+        memcpy(buffer, data, packet.rxSize);
+        return true;
+    }
+
+    // a compact packet only makes sense at exactly the negotiated size
+    if (length != packet.rxSize) return false;
+
+    memcpy(buffer, data, packet.rxSetPoint);       // header and frequency commands
+    memcpy(buffer + storage.rxSetPoint, data + packet.rxSetPoint, 4 * setPoints);
+    memcpy(buffer + storage.rxJointEnable, data + packet.rxJointEnable, sizeof(jointMask_t));
+    memcpy(buffer + storage.rxOutputs, data + packet.rxOutputs, 2);
+    return true;
+}
+
+uint16_t PacketLayout::packTx(const volatile txData_t& tx, uint8_t* data) const
+{
+    const uint8_t* buffer = (const uint8_t*)tx.txBuffer;
+
+    if (full) {
+        memcpy(data, buffer, packet.txSize);
+        return packet.txSize;
+    }
+
+    memset(data, 0, packet.txSize);
+    memcpy(data, buffer, packet.txProcessVariable);     // header and joint feedback
+    memcpy(data + packet.txProcessVariable, buffer + storage.txProcessVariable, 4 * processVariables);
+    memcpy(data + packet.txInputs, buffer + storage.txInputs, 2);
+    return packet.txSize;
+}
+
+uint16_t PacketLayout::writeDescriptor(uint8_t* data) const
+{
+    uint32_t header = Config::pruLayout;
+    uint32_t intMask = processVariables < 32 ? intProcessVariables & ((1u << processVariables) - 1) : intProcessVariables;
+
+    memset(data, 0, descriptorSize);
+    memcpy(data, &header, 4);
+    data[4] = version;
+    data[5] = joints;
+    data[6] = setPoints;
+    data[7] = processVariables;
+    memcpy(data + 8, &packet.rxSize, 2);
+    memcpy(data + 10, &packet.txSize, 2);
+    memcpy(data + 12, &intMask, 4);
+    data[16] = sizeof(jointMask_t);
+    return descriptorSize;
+}
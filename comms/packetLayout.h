@@ -0,0 +1,91 @@
+#ifndef PACKETLAYOUT_H
+#define PACKETLAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../data.h"
+
+// The layout of the packets on the wire, sized to the configured channels.
+//
+// rxData and txData keep their full size (Config::joints, Config::variables),
+// the modules point into them as before. The packets carry only the channels in
+// use, packed in the same order with no gaps:
+//
+//      rx: header | jointFreqCmd[joints] | setPoint[setPoints] | jointEnable | outputs
+//      tx: header | jointFeedback[joints] | processVariable[processVariables] | inputs
+//
+// each rounded up to 4 bytes. With every channel in use this is the fixed
+// rxData/txData layout, so hosts that never ask for the layout see no change.
+//
+// The host sends a packet headed Config::pruLayout and gets the descriptor back:
+//
+//      0   uint32  Config::pruLayout
+//      4   uint8   layout version
+//      5   uint8   joints
+//      6   uint8   set points
+//      7   uint8   process variables
+//      8   uint16  rx packet bytes
+//      10  uint16  tx packet bytes
+//      12  uint32  bit per process variable, set for Int32 ("PV Type")
+//      16  uint8   jointEnable bytes, 1 up to 8 joints, 2 up to 16, else 4
+//
+// Version 1 descriptors were 16 bytes with a one byte jointEnable.
+class PacketLayout
+{
+public:
+    static constexpr uint8_t version = 2;
+    static constexpr uint16_t descriptorSize = 20;
+
+private:
+    struct Offsets {
+        uint16_t rxSetPoint;
+        uint16_t rxJointEnable;
+        uint16_t rxOutputs;
+        uint16_t rxSize;
+        uint16_t txProcessVariable;
+        uint16_t txInputs;
+        uint16_t txSize;
+    };
+
+    uint8_t joints;
+    uint8_t setPoints;
+    uint8_t processVariables;
+    uint32_t intProcessVariables = 0;
+    bool full = true;               // every channel in use, packets are copied straight
+
+    Offsets packet;                 // offsets in the packets
+    Offsets storage;                // offsets in rxData and txData
+
+    static Offsets computeOffsets(uint32_t joints, uint32_t setPoints, uint32_t processVariables);
+
+public:
+    PacketLayout();
+
+    // Returns false, leaving the layout unchanged, when the counts exceed the
+    // rxData/txData channels
+    bool configure(uint32_t _joints, uint32_t _setPoints, uint32_t _processVariables);
+    void setIntProcessVariable(uint32_t index) { if (index < 32) intProcessVariables |= (1u << index); }
+
+    // Copy a received packet into rxData. Returns false, leaving rxData
+    // untouched, for a packet shorter than the layout or, with a compact layout,
+    // any length but the negotiated one. A rejected packet is not new data.
+    bool unpackRx(const uint8_t* data, uint16_t length, volatile rxData_t& rx) const;
+
+    // Build the packet to send from txData, returns its length
+    uint16_t packTx(const volatile txData_t& tx, uint8_t* data) const;
+
+    uint16_t writeDescriptor(uint8_t* data) const;
+
+    uint8_t getJoints() const { return joints; }
+    uint8_t getSetPoints() const { return setPoints; }
+    uint8_t getProcessVariables() const { return processVariables; }
+    uint16_t getRxSize() const { return packet.rxSize; }
+    uint16_t getTxSize() const { return packet.txSize; }
+    bool isFull() const { return full; }
+};
+
+// The layout in use, set from the config at boot
+extern PacketLayout packetLayout;
+
+#endif
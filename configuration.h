@@ -7,12 +7,22 @@
 namespace Config {
     constexpr uint32_t pruBaseFreq = 40000;        // PRU Base thread ISR update frequency (hz)
     constexpr uint32_t pruServoFreq = 1000;        // PRU Servo thread ISR update frequency (hz)
+    constexpr uint32_t threadIrqPriority = 3;      // Timer IRQ priority for config declared threads without a "Priority"
     constexpr uint32_t oversample = 3;
     constexpr uint32_t swBaudRate = 19200;         // Software serial baud rate
     constexpr uint32_t pruSerialFreq = swBaudRate * oversample;
+    constexpr bool staggerSlowUpdates = true;      // Spread slowUpdate() work across the thread ticks rather than running it all on the same tick
+    constexpr uint32_t staggerSearchPhases = 64;   // Phases tried per slowUpdate() task when staggering, bounds the task table compile time
+    constexpr uint32_t threadStatsInterval = 0;    // Seconds between thread ISR timing reports, 0 = disabled (needs a HAL CycleCounter)
+    constexpr uint32_t overloadPercent = 90;       // Tick duration, as % of the period, above which low priority modules are shed
+    constexpr uint32_t loadShedTicks = 1000;       // Ticks to keep shedding after the last overloaded tick
+    constexpr uint32_t overrunClearSeconds = 5;    // Seconds without a thread overrun before the THREAD_OVERRUN status is cleared
+    constexpr uint32_t moduleArenaSize = 8192;     // Bytes of static memory for the module objects created from the config and their HAL objects
+    constexpr uint32_t moduleReportTopN = 10;      // Modules listed per thread in the MODULE_PROFILING report (build flag)
 
-    constexpr uint32_t stepBit = 22;               // Bit location in DDS accum
-    constexpr uint32_t stepMask = (1L << stepBit);
+    constexpr uint32_t minPortPulseNs = 0;         // Minimum time between the PortWriter's update and post flushes (ns), 0 = none, needs a CycleCounter and HAL_PORT_IO
+
+    constexpr uint32_t ddsResolutionBits = 16;     // Stepgen DDS fractional frequency bits, 0 to 24
 
     constexpr uint32_t joints = 8;                 // Number of joints
     constexpr uint32_t variables = 6;              // Number of command values
@@ -27,6 +37,7 @@ namespace Config {
     constexpr uint32_t pruEstop = 0x65737470;      // "estp" SPI payload
     constexpr uint32_t pruAcknowledge = 0x61636b6e;// "ackn" SPI payload
     constexpr uint32_t pruErr = 0x6572726f;        // "erro" payload
+    constexpr uint32_t pruLayout = 0x6c61796f;     // "layo" payload, the host asks for the packet layout
 
     // IRQ priorities
     constexpr uint32_t baseThreadIrqPriority = 1;
@@ -2,8 +2,14 @@
 #define DATA_H
 
 #include <stdint.h>  // Add this line for uint8_t type
+#include <type_traits>
 #include "configuration.h"
 
+// The joint enable bits, one per joint, in the narrowest type that holds
+// Config::joints. Up to 8 joints keep the single byte the host drivers expect.
+typedef std::conditional<Config::joints <= 8, uint8_t,
+        std::conditional<Config::joints <= 16, uint16_t, uint32_t>::type>::type jointMask_t;
+
 #pragma pack(push, 1)
 typedef union rxData_t
 {
@@ -17,7 +23,7 @@ typedef union rxData_t
     int32_t header;
     volatile int32_t jointFreqCmd[Config::joints]; 	// Base thread commands ?? - basically motion
     float setPoint[Config::variables];		  // Servo thread commands ?? - temperature SP, PWM etc
-    uint8_t jointEnable;
+    jointMask_t jointEnable;
     uint16_t outputs;
     uint8_t spare0;
   };
@@ -35,6 +41,8 @@ typedef union rxData_t
   }
 } __attribute__((aligned(32))) rxData_t;
 
+static_assert(Config::joints <= 8 * sizeof(rxData_t::jointEnable), "Config::joints has more joints than jointEnable has bits");
+
 
 typedef union txData_t
 {
@@ -47,7 +55,10 @@ typedef union txData_t
   {
     int32_t header;
     int32_t jointFeedback[Config::joints];	  // Base thread feedback ??
-    float processVariable[Config::variables];		     // Servo thread feedback ??
+    union {
+      float processVariable[Config::variables];		     // Servo thread feedback ??
+      int32_t processVariableInt[Config::variables];   // the same slots, for PVs declared "PV Type": "Int32" (or "Index Timestamp PV Type")
+    };
 	uint16_t inputs;
   };
 
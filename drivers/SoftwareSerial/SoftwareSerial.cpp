@@ -128,7 +128,7 @@ void SoftwareSerial::send(void)
             {
                 activeTx = false;    // output pending allow new byte to be written to txBuffer from write()
             }
-            else if (txBitCnt > 10 + Config::oversample*5)
+            else if (txBitCnt > (int32_t)(10 + Config::oversample*5))
             {
                 if (halfDuplex)
                 {
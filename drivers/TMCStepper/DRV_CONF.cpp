@@ -0,0 +1,26 @@
+#include "TMCStepper.h"
+#include "TMC_MACROS.h"
+
+#define SET_REG(SETTING) DRV_CONF_register.SETTING = B; write(DRV_CONF_register.address, DRV_CONF_register.sr)
+
+// DRV_CONF
+
+uint32_t TMC2160Stepper::DRV_CONF() {
+    return DRV_CONF_register.sr;
+}
+void TMC2160Stepper::DRV_CONF(uint32_t input) {
+    DRV_CONF_register.sr = input;
+    write(DRV_CONF_register.address, DRV_CONF_register.sr);
+}
+
+void TMC2160Stepper::bbmtime(uint8_t B)     { SET_REG(bbmtime);     }
+void TMC2160Stepper::bbmclks(uint8_t B)     { SET_REG(bbmclks);     }
+void TMC2160Stepper::otselect(uint8_t B)    { SET_REG(otselect);    }
+void TMC2160Stepper::drvstrength(uint8_t B) { SET_REG(drvstrength); }
+void TMC2160Stepper::filt_isense(uint8_t B) { SET_REG(filt_isense); }
+
+uint8_t TMC2160Stepper::bbmtime()           { return DRV_CONF_register.bbmtime;     }
+uint8_t TMC2160Stepper::bbmclks()           { return DRV_CONF_register.bbmclks;     }
+uint8_t TMC2160Stepper::otselect()          { return DRV_CONF_register.otselect;    }
+uint8_t TMC2160Stepper::drvstrength()       { return DRV_CONF_register.drvstrength; }
+uint8_t TMC2160Stepper::filt_isense()       { return DRV_CONF_register.filt_isense; }
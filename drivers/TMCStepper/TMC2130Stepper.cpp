@@ -4,6 +4,7 @@
 // only software SPI supported
 
 int8_t TMC2130Stepper::chain_length = 0;
+uint32_t TMC2130Stepper::spi_speed = 16000000/8;
 
 TMC2130Stepper::TMC2130Stepper(const std::string& pinCS, float RS, const std::string& pinMOSI, const std::string& pinMISO, const std::string& pinSCK, int8_t link)
     : TMCStepper(RS),
@@ -26,6 +26,9 @@ namespace network
     volatile uint8_t tail = 0;
     volatile uint8_t dropped_packets = 0;    
 
+    // reply packet, built from txData in the configured packet layout
+    static uint8_t txPacket[Config::dataBuffSize] __attribute__((aligned(4)));
+
     static ip_addr_t g_ip;
     static ip_addr_t g_mask;
     static ip_addr_t g_gateway;
@@ -169,27 +172,42 @@ namespace network
         
         // ours will just process the latest entry. Again this doesn't handle the lost packet, parts of the ring buffer is just there to detect it. The PRU will always read the latest packet
         assert(((uintptr_t)network::ptr_eth_comms->ptrRxData % alignof(rxData_t)) == 0);                   // rxBuffer is aligned to 32bits. Could easily end up in a situation where other platform builds don't respect this
-        memcpy((void *)network::ptr_eth_comms->ptrRxData, p->payload, p->len); 
 
-        //received a PRU request
-        if (network::ptr_eth_comms->ptrRxData->header == Config::pruRead)
-        {       
-            network::ptr_eth_comms->ptrTxData->header = Config::pruData;
-            txlen = Config::dataBuffSize;
-            network::ptr_eth_comms->flag_new_data();      
+        uint32_t header = 0;
+        if (p->len >= sizeof(header)) memcpy(&header, p->payload, sizeof(header));
+
+        if (header == Config::pruLayout)
+        {
+            // the host asks for the packet layout, rxData is left alone
+            txlen = network::ptr_eth_comms->writeLayoutDescriptor(txPacket);
         }
-        else if (network::ptr_eth_comms->ptrRxData->header == Config::pruWrite)
+        else if (!network::ptr_eth_comms->unpackRx((const uint8_t*)p->payload, p->len))
         {
-            network::ptr_eth_comms->ptrTxData->header = Config::pruAcknowledge;
-            txlen = Config::dataBuffSize;   
-            network::ptr_eth_comms->flag_new_data();      
-        }	
+            // the wrong size for the layout, rxData is left alone and there is no new data
+            printf("Warning, PRU is ignoring a %d byte packet, the layout needs %d\n", p->len, packetLayout.getRxSize());
+        }
+        else
+        {
+            //received a PRU request
+            if (network::ptr_eth_comms->ptrRxData->header == Config::pruRead)
+            {       
+                network::ptr_eth_comms->ptrTxData->header = Config::pruData;
+                network::ptr_eth_comms->flag_new_data();      
+                txlen = network::ptr_eth_comms->packTx(txPacket);
+            }
+            else if (network::ptr_eth_comms->ptrRxData->header == Config::pruWrite)
+            {
+                network::ptr_eth_comms->ptrTxData->header = Config::pruAcknowledge;
+                network::ptr_eth_comms->flag_new_data();      
+                txlen = network::ptr_eth_comms->packTx(txPacket);
+            }	
+        }
 
         // allocate pbuf from RAM
         txBuf = pbuf_alloc(PBUF_TRANSPORT, txlen, PBUF_RAM);
 
         // copy the data into the buffer
-        pbuf_take(txBuf, (char*)&network::ptr_eth_comms->ptrTxData->txBuffer, txlen);
+        pbuf_take(txBuf, (char*)txPacket, txlen);
 
         // Connect to the remote client
         udp_connect(upcb, addr, port);
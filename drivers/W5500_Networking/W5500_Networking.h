@@ -50,6 +50,7 @@ Without these build flags, this header and the cpp file have been commented out
 #include <memory>
 
 #include "remora-core/comms/commsInterface.h"
+#include "remora-core/comms/packetLayout.h"
 #include "../../json/jsonConfigHandler.h"
 
 #include "remora-hal/pin/pin.h"
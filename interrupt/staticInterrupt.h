@@ -0,0 +1,62 @@
+#ifndef STATICINTERRUPT_H
+#define STATICINTERRUPT_H
+
+#include <cstdint>
+
+// Compile-time bound interrupt handlers.
+//
+// The Interrupt table goes IRQ handler -> InvokeHandler -> ISRVectorTable[n] ->
+// virtual ISR_Handler -> owner. With these templates the owner type, and for
+// modules the member function, are template parameters, so the IRQ handler
+// makes a direct (inlinable) call to the owner. Only the owner pointer is
+// stored, one per IrqNumber, which is the IRQ number or any number unique to
+// the interrupt source, eg the QEI instance.
+//
+// The platform's IRQ handler calls handle() in place of Interrupt::InvokeHandler,
+// and the owner is bound once it exists, in place of creating a TimerInterrupt
+// or ModuleInterrupt:
+//
+//      extern "C" void TIM2_IRQHandler() { TimerIrq<TIM2_IRQn, STM32Timer>::handle(); }
+//      TimerIrq<TIM2_IRQn, STM32Timer>::bind(timer);
+//
+//      extern "C" void EXTI15_10_IRQHandler() { ...; QEI::IndexIrq<0>::handle(); }
+//
+// QEI::IndexIrq is a ModuleIrq the QEI binds itself to. VirtualTimer dispatches
+// its ticks through a TimerIrq table in the same way.
+
+// Timer interrupt, calls Timer::timerTick() without going through the pruTimer
+// vtable. Timer is the platform's concrete pruTimer.
+template <uint32_t IrqNumber, typename Timer>
+class TimerIrq
+{
+private:
+    static inline Timer* timer = nullptr;
+
+public:
+    static void bind(Timer* _timer) { timer = _timer; }
+    static void unbind() { timer = nullptr; }
+
+    static inline void handle()
+    {
+        if (timer) timer->Timer::timerTick();
+    }
+};
+
+// Module interrupt, calls the handler member function of the owning module
+template <uint32_t IrqNumber, typename DerivedModule, void (DerivedModule::*Handler)()>
+class ModuleIrq
+{
+private:
+    static inline DerivedModule* module = nullptr;
+
+public:
+    static void bind(DerivedModule* _module) { module = _module; }
+    static void unbind() { module = nullptr; }
+
+    static inline void handle()
+    {
+        if (module) (module->*Handler)();
+    }
+};
+
+#endif
@@ -14,6 +14,7 @@ JsonConfigHandler::JsonConfigHandler(Remora* _remora) :
         return;
     }
     updateThreadFreq();
+    updatePacketLayout();
 }
 
 uint8_t JsonConfigHandler::loadConfiguration() {
@@ -55,20 +56,49 @@ void JsonConfigHandler::updateThreadFreq() {
             const char* configor = thread["Thread"];
             uint32_t    freq = thread["Frequency"];
             if (!strcmp(configor,"Base")) {
-                printf("Updating thread frequency - Setting BASE thread frequency to %lu\n", freq);
+                printf("Updating thread frequency - Setting BASE thread frequency to %lu\n", (unsigned long)freq);
                 remoraInstance->setBaseFreq(freq);
             }
             else if (!strcmp(configor,"Servo")) {
-                printf("Updating thread frequency - Setting SERVO thread frequency to %lu\n", freq);
+                printf("Updating thread frequency - Setting SERVO thread frequency to %lu\n", (unsigned long)freq);
                 remoraInstance->setServoFreq(freq);
             }
+            else {
+                // any other name declares an additional thread, "Priority" is its timer IRQ priority
+                uint32_t priority = thread["Priority"] | Config::threadIrqPriority;
+                printf("Creating %s thread - frequency %lu, IRQ priority %lu\n", configor, (unsigned long)freq, (unsigned long)priority);
+                remoraInstance->addThread(configor, freq, priority);
+            }
         }
     }
     else 
     {
-        printf("BASE thread frequency set to: %lu\n", remoraInstance->getBaseFreq());
-        printf("SERVO thread frequency set to: %lu\n", remoraInstance->getServoFreq());
+        printf("BASE thread frequency set to: %lu\n", (unsigned long)remoraInstance->getBaseFreq());
+        printf("SERVO thread frequency set to: %lu\n", (unsigned long)remoraInstance->getServoFreq());
+    }
+}
+
+// "Packet": {"Joints": 3, "Set Points": 1, "Process Variables": 2} sizes the
+// packets to the channels in use, without it the packets carry every channel
+void JsonConfigHandler::updatePacketLayout() {
+
+    JsonObject packet = doc["Packet"];
+    if (packet.isNull()) return;
+
+    uint32_t joints = packet["Joints"] | Config::joints;
+    uint32_t setPoints = packet["Set Points"] | Config::variables;
+    uint32_t processVariables = packet["Process Variables"] | Config::variables;
+
+    PacketLayout& layout = remoraInstance->getPacketLayout();
+    if (!layout.configure(joints, setPoints, processVariables)) {
+        printf("Error: packet layout of %lu joints, %lu set points and %lu process variables does not fit\n",
+               (unsigned long)joints, (unsigned long)setPoints, (unsigned long)processVariables);
+        remoraInstance->setStatus(makeRemoraStatus(RemoraErrorSource::JSON_CONFIG, RemoraErrorCode::PACKET_LAYOUT_INVALID));
+        return;
     }
+    printf("Packet layout - %lu joints, %lu set points, %lu process variables, rx %u bytes, tx %u bytes\n",
+           (unsigned long)joints, (unsigned long)setPoints, (unsigned long)processVariables,
+           (unsigned)layout.getRxSize(), (unsigned)layout.getTxSize());
 }
 
 JsonArray JsonConfigHandler::getModules() {
@@ -100,7 +130,7 @@ uint8_t JsonConfigHandler::readConfigFromSD() {
     }
 
     int32_t length = f_size(&SDFile);
-    printf("JSON config file length = %2ld\n", length);
+    printf("JSON config file length = %2ld\n", (long)length);
 
     __attribute__((aligned(32))) char rtext[length];
     if(f_read(&SDFile, rtext, length, (UINT *)&bytesread) != FR_OK)
@@ -41,6 +41,7 @@ public:
 
 	JsonConfigHandler(Remora* _remora);
 	void updateThreadFreq();
+	void updatePacketLayout();
 	JsonArray getModules();
 	JsonObject getModuleConfig(const char* threadName, const char* moduleType);	
 
@@ -0,0 +1,71 @@
+#include <cstdio>
+
+#include "moduleArena.h"
+#include "../configuration.h"
+
+namespace {
+    constexpr size_t arenaAlign = alignof(std::max_align_t);
+    alignas(arenaAlign) uint8_t arena[Config::moduleArenaSize];
+}
+
+ModuleArena::State ModuleArena::state = ModuleArena::IDLE;
+size_t ModuleArena::used = 0;
+uint32_t ModuleArena::allocations = 0;
+uint32_t ModuleArena::overflows = 0;
+uint32_t ModuleArena::lateAllocations = 0;
+
+void ModuleArena::begin()
+{
+    if (state != FROZEN) state = ACTIVE;
+}
+
+void ModuleArena::end()
+{
+    if (state == ACTIVE) state = IDLE;
+}
+
+void ModuleArena::freeze()
+{
+    state = FROZEN;
+}
+
+void* ModuleArena::allocate(size_t size)
+{
+    if (state == FROZEN) {
+        lateAllocations++;
+        return nullptr;
+    }
+    if (state != ACTIVE) return nullptr;
+
+    size_t aligned = (size + arenaAlign - 1) & ~(arenaAlign - 1);
+    if (aligned > sizeof(arena) - used) {
+        overflows++;            // fall back to the heap
+        return nullptr;
+    }
+
+    void* ptr = &arena[used];
+    used += aligned;
+    allocations++;
+    return ptr;
+}
+
+bool ModuleArena::contains(const void* ptr)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    return p >= arena && p < arena + sizeof(arena);
+}
+
+size_t ModuleArena::getSize()
+{
+    return sizeof(arena);
+}
+
+void ModuleArena::report()
+{
+    printf("Module arena: %u of %u bytes used by %lu modules and HAL objects\n",
+           (unsigned)used, (unsigned)sizeof(arena), (unsigned long)allocations);
+    if (overflows) {
+        printf("Warning: module arena exhausted, %lu objects taken from the heap, increase Config::moduleArenaSize\n", (unsigned long)overflows);
+    }
+}
+
@@ -0,0 +1,83 @@
+#ifndef MODULE_ARENA_H
+#define MODULE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Bump allocator for the module objects created while the config is loaded,
+// and the HAL objects they own. Module::operator new draws from the arena
+// between begin() and end(), and the modules create their pins, counters and
+// ADC channels with make() or makeUnique(), so the hot path objects sit in one
+// static block instead of being scattered through the heap. Strings, vectors
+// and load time temporaries still use the heap. Objects are never freed once
+// loaded, deletes of arena memory only run the destructor. Only used from the
+// main loop, the arena is not interrupt safe.
+//
+// Once the threads are running the arena is frozen, objects created later come
+// from the heap but are counted so they can be reported.
+class ModuleArena
+{
+private:
+    enum State : uint8_t {
+        IDLE = 0,       // modules go to the heap
+        ACTIVE,         // modules go to the arena
+        FROZEN          // modules go to the heap and are counted
+    };
+
+    static State state;
+    static size_t used;
+    static uint32_t allocations;
+    static uint32_t overflows;
+    static uint32_t lateAllocations;
+
+public:
+    static void begin();
+    static void end();
+    static void freeze();
+
+    // Called from Module::operator new, returns nullptr when the allocation is
+    // not taken from the arena
+    static void* allocate(size_t size);
+    static bool contains(const void* ptr);
+
+    // Create a T in the arena, or on the heap when the arena is not active or
+    // is full. Free it with destroy(), or own it with a Ptr from makeUnique().
+    template <typename T, typename... Args>
+    static T* make(Args&&... args)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "the arena aligns to max_align_t");
+        void* ptr = allocate(sizeof(T));
+        if (!ptr) ptr = ::operator new(sizeof(T));
+        return new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    static void destroy(T* ptr)
+    {
+        if (!ptr) return;
+        ptr->~T();
+        if (!contains(ptr)) ::operator delete(ptr);
+    }
+
+    struct Deleter {
+        template <typename T>
+        void operator()(T* ptr) const { destroy(ptr); }
+    };
+
+    template <typename T>
+    using Ptr = std::unique_ptr<T, Deleter>;
+
+    template <typename T, typename... Args>
+    static Ptr<T> makeUnique(Args&&... args) { return Ptr<T>(make<T>(std::forward<Args>(args)...)); }
+
+    static size_t getUsed() { return used; }
+    static size_t getSize();
+    static uint32_t getOverflows() { return overflows; }
+    static uint32_t getLateAllocations() { return lateAllocations; }
+    static void report();
+};
+
+#endif
@@ -6,6 +6,7 @@ std::shared_ptr<Module> AnalogPin::create(const JsonObject& config, Remora* inst
     printf("%s\n", comment);
 
     int pv = config["PV[i]"];
+    if (!instance->checkProcessVariable(pv, "PV[i]")) return nullptr;
     volatile float* ptrProcessVariable = &instance->getTxData()->processVariable[pv];
 	
     const char* pin = config["Pin"];
@@ -18,7 +19,8 @@ AnalogPin::AnalogPin(volatile float &ptrFeedback, std::string _portAndPin) :
     ptrFeedback(&ptrFeedback),
     portAndPin(std::move(_portAndPin))
 {
-    this->adc = new AnalogIn(this->portAndPin);
+    this->adc = ModuleArena::make<AnalogIn>(this->portAndPin);
+    bindTasks<AnalogPin>();
 }
 
 void AnalogPin::update()
@@ -19,11 +19,13 @@ std::shared_ptr<Module> Blink::create(const JsonObject& config, Remora* instance
  */
 Blink::Blink(std::string _portAndPin, uint32_t _threadFreq, uint32_t _freq) :
 	bState(false),
+    frequency(_freq),
     periodCount(_threadFreq / _freq),
     blinkCount(0),
-    blinkPin(std::make_unique<Pin>(_portAndPin, OUTPUT))
+    blinkPin(ModuleArena::makeUnique<Pin>(_portAndPin, OUTPUT))
 {
 	blinkPin->set(bState);
+	bindTasks<Blink>();
 }
 
 void Blink::update(void)
@@ -41,3 +43,10 @@ void Blink::slowUpdate(void)
 {
 	return;
 }
+
+void Blink::changeThreadFreq(int32_t _threadFreq)
+{
+	Module::changeThreadFreq(_threadFreq);
+	periodCount = _threadFreq / frequency;
+	if (blinkCount >= periodCount / 2) blinkCount = 0;
+}
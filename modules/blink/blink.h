@@ -19,10 +19,11 @@ class Blink : public Module
 private:
 
 	bool 					bState;
+	uint32_t 				frequency;
 	uint32_t 				periodCount;
 	uint32_t 				blinkCount;
 
-	std::unique_ptr<Pin> 	blinkPin;
+	ModuleArena::Ptr<Pin> 	blinkPin;
 
 public:
 
@@ -31,6 +32,7 @@ public:
 
 	virtual void update(void);
 	virtual void slowUpdate(void);
+	virtual void changeThreadFreq(int32_t);
 };
 
 #endif
@@ -2,6 +2,7 @@
 #include "../../remora.h"
 
 CommsHandler::CommsHandler() : data(false), noDataCount(0), status(false) {
+	bindTasks<CommsHandler>();
 
 }
 
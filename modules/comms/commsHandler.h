@@ -28,6 +28,10 @@ public:
     void init();
     void start();
 
+    // the interface's packet layout copies, see CommsInterface
+    bool unpackRx(const uint8_t* data, uint16_t length) { return interface->unpackRx(data, length); }
+    uint16_t packTx(uint8_t* data) { return interface->packTx(data); }
+
     void setData(bool value) { data = value; }
     void setNoDataCount(int count) { noDataCount = count; }
     void setStatus(bool value) { status = value; }
@@ -0,0 +1,56 @@
+#ifndef DDSSCALE_H
+#define DDSSCALE_H
+
+#include <cstdint>
+
+// Rescale a DDS value (accumulator phase or add value) from one step unit to
+// another, value * to / from rounded towards zero.
+//
+// The step units are threadFreq << R, up to about 2^55, so the product can
+// need more than 64 bits. It is formed in 128 bits from 32 bit halves and
+// divided back down by shift and subtract. Only used when a thread is retimed.
+inline int64_t scaleDDSUnits(int64_t value, int64_t to, int64_t from)
+{
+    if (value == 0 || to == from || from <= 0 || to <= 0) return value;
+
+    bool negative = value < 0;
+    uint64_t v = negative ? 0 - (uint64_t)value : (uint64_t)value;
+    uint64_t t = (uint64_t)to;
+    uint64_t f = (uint64_t)from;
+
+    // whole units of from scale exactly, only the remainder needs the wide product
+    uint64_t result = (v / f) * t;
+    uint64_t r = v % f;
+
+    if (r <= UINT64_MAX / t) {
+        result += r * t / f;
+    } else {
+        // 128 bit r * t
+        uint64_t rLo = (uint32_t)r, rHi = r >> 32;
+        uint64_t tLo = (uint32_t)t, tHi = t >> 32;
+        uint64_t lo = rLo * tLo;
+        uint64_t mid1 = rHi * tLo;
+        uint64_t mid2 = rLo * tHi;
+        uint64_t hi = rHi * tHi + (mid1 >> 32) + (mid2 >> 32);
+        uint64_t mid = (lo >> 32) + (uint32_t)mid1 + (uint32_t)mid2;
+        hi += mid >> 32;
+        lo = (mid << 32) | (uint32_t)lo;
+
+        // (hi:lo) / f, the quotient is below t since r < f, and f < 2^63 so the
+        // remainder shifted left one bit still fits
+        uint64_t quotient = 0, remainder = 0;
+        for (int bit = 127; bit >= 0; bit--) {
+            uint64_t next = bit >= 64 ? (hi >> (bit - 64)) & 1 : (lo >> bit) & 1;
+            remainder = (remainder << 1) | next;
+            if (remainder >= f) {
+                remainder -= f;
+                if (bit < 64) quotient |= (uint64_t)1 << bit;
+            }
+        }
+        result += quotient;
+    }
+
+    return negative ? -(int64_t)result : (int64_t)result;
+}
+
+#endif
@@ -4,7 +4,8 @@
 Debug::Debug(std::string portAndPin, bool bstate) :
     bState(bstate)
 {
-	this->debugPin = new Pin(portAndPin, OUTPUT);
+	this->debugPin = ModuleArena::make<Pin>(portAndPin, OUTPUT);
+	bindTasks<Debug>();
 }
 
 void Debug::update(void)
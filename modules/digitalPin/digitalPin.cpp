@@ -38,9 +38,10 @@ DigitalPin::DigitalPin(volatile uint16_t& _ptrData, int _mode, std::string _port
     bitNumber(_bitNumber),
     invert(_invert),
     modifier(_modifier),
-    pin(std::make_unique<Pin>(portAndPin, mode, modifier)),
+    pin(ModuleArena::makeUnique<Pin>(portAndPin, mode, modifier)),
     mask(1 << bitNumber)
 {
+    bindTasks<DigitalPin>();
 }
 
 void DigitalPin::update()
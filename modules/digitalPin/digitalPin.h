@@ -25,7 +25,7 @@ private:
     int bitNumber;              /**< Bit position in the data source. */
     bool invert;                /**< Flag for inverting logic. */
     int modifier;               /**< Modifier (e.g., pull-up, open-drain). */
-    std::unique_ptr<Pin> pin;   /**< Pointer to the GPIO pin object. */
+    ModuleArena::Ptr<Pin> pin;   /**< Pointer to the GPIO pin object. */
     int mask;                   /**< Bit mask for data manipulation. */
 
 public:
@@ -1,44 +1,74 @@
+
 #include "module.h"
+#include "../memory/moduleArena.h"
 
-#include <cstdio>
+#include <new>
 
-Module::Module()
+Module::Module() :
+	updateFunction(defaultUpdate),
+	updatePostFunction(defaultUpdatePost),
+	slowUpdateFunction(defaultSlowUpdate)
 {
-	this->counter = 0;
-	this->updateCount = 1;
-	printf("\nCreating a std module\n");
 }
 
 
 Module::Module(int32_t threadFreq, int32_t slowUpdateFreq) :
 	threadFreq(threadFreq),
-	slowUpdateFreq(slowUpdateFreq)
+	slowUpdateFreq(slowUpdateFreq),
+	usesSlowUpdate(true),
+	updateFunction(defaultUpdate),
+	updatePostFunction(defaultUpdatePost),
+	slowUpdateFunction(defaultSlowUpdate)
 {
-	this->counter = 0;
-	this->updateCount = this->threadFreq / this->slowUpdateFreq;
-	printf("\nCreating a slower module, updating every %ld thread cycles\n",this->updateCount);
 }
 
 Module::~Module(){}
 
 
-void Module::runModule()
+void* Module::operator new(std::size_t size)
+{
+	void* ptr = ModuleArena::allocate(size);
+	return ptr ? ptr : ::operator new(size);
+}
+
+
+void Module::operator delete(void* ptr) noexcept
+{
+	if (!ModuleArena::contains(ptr)) ::operator delete(ptr);
+}
+
+
+void Module::defaultUpdate(Module* m)
+{
+	m->update();
+}
+
+
+void Module::defaultUpdatePost(Module* m)
+{
+	m->updatePost();
+}
+
+
+void Module::defaultSlowUpdate(Module* m)
 {
-	++this->counter;
+	m->slowUpdate();
+}
 
-	if (this->counter >= this->updateCount)
+bool Module::defer(DeferredFunction function, int32_t arg, float value)
+{
+	if (!this->workQueue)
 	{
-		this->slowUpdate();
-		this->counter = 0;
+		function(static_cast<Module*>(this), arg, value);
+		return true;
 	}
 
-	this->update();
+	return this->workQueue->post({ function, static_cast<Module*>(this), arg, value });
 }
 
-
-void Module::runModulePost()
+void Module::changeThreadFreq(int32_t freq)
 {
-	this->updatePost();
+	this->threadFreq = freq;
 }
 
 void Module::update(){}
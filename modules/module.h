@@ -1,7 +1,57 @@
 #ifndef MODULE_H
 #define MODULE_H
 
+#include <cstddef>
 #include <cstdint>
+#ifdef MODULE_PROFILING
+#include <string>
+#endif
+
+#include "../memory/moduleArena.h"
+#include "../thread/deferredQueue.h"
+
+class Module;
+class PortWriter;
+class PortReader;
+
+// A compiled thread task: a plain function pointer and the module it runs on.
+// pruThread flattens its registered modules into a contiguous array of these
+// so the ISR makes one indirect call per task, with no shared_ptr or vtable hop.
+typedef void (*ModuleTaskFunction)(Module*);
+
+struct ModuleTask
+{
+	ModuleTaskFunction function;
+	Module* module;
+};
+
+// The kinds of work a module hands to its thread
+enum TaskKind : uint8_t
+{
+	TASK_SLOW_UPDATE = 0,
+	TASK_UPDATE,
+	TASK_UPDATE_POST,
+	TASK_KINDS
+};
+
+#ifdef MODULE_PROFILING
+// Per-module task timing in cycle counter counts, written by the thread ISR.
+// Build with -DMODULE_PROFILING to enable, otherwise none of this is compiled.
+struct TaskTiming
+{
+	uint32_t max;
+	uint32_t count;
+	uint64_t sum;
+};
+#endif
+
+// Priority is used to shed work when a thread is overloaded, LOW priority
+// modules are skipped until the thread has recovered
+enum ModulePriority : uint8_t
+{
+	PRIORITY_LOW = 0,
+	PRIORITY_NORMAL = 1
+};
 
 // Module base class
 // All modules are derived from this base class
@@ -12,9 +62,45 @@ class Module
 
 		int32_t threadFreq;
 		int32_t slowUpdateFreq;
-		int32_t updateCount;
-		int32_t counter;
+        bool usesModuleUpdate = true;
         bool usesModulePost = false;
+        bool usesSlowUpdate = false;
+        ModulePriority priority = PRIORITY_NORMAL;
+
+        ModuleTaskFunction updateFunction;
+        ModuleTaskFunction updatePostFunction;
+        ModuleTaskFunction slowUpdateFunction;
+
+        ThreadWorkQueue* workQueue = nullptr;  // set when registered in a thread
+        PortWriter* portWriter = nullptr;      // the thread's staged GPIO writes, also set at registration
+        PortReader* portReader = nullptr;      // the thread's sampled GPIO inputs, also set at registration
+
+#ifdef MODULE_PROFILING
+        std::string moduleType;
+        std::string comment;
+        TaskTiming timing[TASK_KINDS] = {};
+#endif
+
+        // Hand work to the main loop, the function gets this module (as a Module*)
+        // as its context. Outside of a thread (eg from the constructor) the work
+        // is run straight away.
+        bool defer(DeferredFunction function, int32_t arg = 0, float value = 0.0f);
+
+        // Default task functions, used until a derived class calls bindTasks<T>()
+        static void defaultUpdate(Module*);
+        static void defaultUpdatePost(Module*);
+        static void defaultSlowUpdate(Module*);
+
+        // Bind the task functions to the derived class so the thread calls
+        // T::update() etc. directly rather than through the vtable.
+        // Call from the derived constructor: bindTasks<Stepgen>();
+        template <typename T>
+        void bindTasks()
+        {
+            updateFunction = [](Module* m) { static_cast<T*>(m)->T::update(); };
+            updatePostFunction = [](Module* m) { static_cast<T*>(m)->T::updatePost(); };
+            slowUpdateFunction = [](Module* m) { static_cast<T*>(m)->T::slowUpdate(); };
+        }
 
 	public:
 
@@ -22,14 +108,38 @@ class Module
 		Module(int32_t, int32_t);	// constructor to run the module at a "slow update frequency" < thread frequency
 
 		virtual ~Module();
-		void runModule();			// the standard interface that the thread runs at the thread frequency, this calls update() at the module frequency
-		void runModulePost();
+
+        // Modules created while the config is loaded come from the ModuleArena,
+        // the HAL objects they own from ModuleArena::make()
+        static void* operator new(std::size_t size);
+        static void operator delete(void* ptr) noexcept;
 		virtual void update();		// the standard interface for update of the module - use for stepgen, PWM etc
 		virtual void updatePost();
-		virtual void slowUpdate();	// the standard interface for the slow update - use for PID controller etc
+		virtual void slowUpdate();	// the standard interface for the slow update - use for PID controller etc, scheduled by the thread's rate groups
         virtual void configure();   // the standard interface for one off configuration
+        virtual void changeThreadFreq(int32_t);    // rescale to a new thread frequency, called from the thread ISR
+        virtual void changeServoFreq(uint32_t) {}  // the servo thread, the rate new commands arrive, was retimed. Called from the thread ISR
 
         virtual bool getUsesModulePost() const { return usesModulePost; }
+        bool getUsesModuleUpdate() const { return usesModuleUpdate; }
+        bool getUsesSlowUpdate() const { return usesSlowUpdate; }
+        int32_t getSlowUpdateFreq() const { return slowUpdateFreq; }
+        void setWorkQueue(ThreadWorkQueue* queue) { workQueue = queue; }
+        virtual void setPortWriter(PortWriter* writer) { portWriter = writer; }    // override to bind the module's output pins
+        virtual void setPortReader(PortReader* reader) { portReader = reader; }    // override to bind the module's input pins
+        void setPriority(ModulePriority _priority) { priority = _priority; }
+        ModulePriority getPriority() const { return priority; }
+
+#ifdef MODULE_PROFILING
+        void setName(const char* _type, const char* _comment) { moduleType = _type ? _type : ""; comment = _comment ? _comment : ""; }
+        const std::string& getModuleType() const { return moduleType; }
+        const std::string& getComment() const { return comment; }
+        TaskTiming& getTiming(TaskKind kind) { return timing[kind]; }
+#endif
+
+        ModuleTask getUpdateTask() { return { updateFunction, this }; }
+        ModuleTask getUpdatePostTask() { return { updatePostFunction, this }; }
+        ModuleTask getSlowUpdateTask() { return { slowUpdateFunction, this }; }
 };
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef MODULEINTERRUPT_H
 #define MODULEINTERRUPT_H
 
+#include "../configuration.h"
 #include "../interrupt/interrupt.h"
 #include "module.h"
 
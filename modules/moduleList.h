@@ -13,6 +13,7 @@
 #include "resetPin/resetPin.h"
 #include "sigmaDelta/sigmaDelta.h"
 #include "stepgen/stepgen.h"
+#include "stepgenBank/stepgenBank.h"
 #include "temperature/temperature.h"
 #include "tmc/tmc.h"
 #include "softEncoder/softEncoder.h"
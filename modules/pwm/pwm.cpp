@@ -48,11 +48,11 @@ std::shared_ptr<Module> PWM::create(const JsonObject& config, Remora* instance)
 ************************************************************************/
 
 PWM::PWM(volatile float &_ptrPwmPeriod, volatile float &_ptrPwmPulseWidth, bool _variable_freq, int _fixed_period_us, int _pwmMax, std::string _pin):
+    pin(_pin),
+    pwmMax(_pwmMax),
     ptrPwmPeriod(&_ptrPwmPeriod),
-    variable_freq(_variable_freq),
     ptrPwmPulseWidth(&_ptrPwmPulseWidth),
-    pwmMax(_pwmMax),
-    pin(_pin)
+    variable_freq(_variable_freq)
 {
     // set initial period and pulse width
     if (variable_freq == true)
@@ -73,7 +73,9 @@ PWM::PWM(volatile float &_ptrPwmPeriod, volatile float &_ptrPwmPulseWidth, bool
 
     setPwmMax(pwmMax);
     
-    hardware_PWM = new HardwarePWM(pwmPeriod_us, pwmPulseWidth, pin); 
+    hardware_PWM = ModuleArena::make<HardwarePWM>(pwmPeriod_us, pwmPulseWidth, pin); 
+
+    bindTasks<PWM>();
 }
 
 void PWM::setPwmMax(int pwmMax) 
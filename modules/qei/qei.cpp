@@ -1,5 +1,29 @@
 #include "qei.h"
 
+// A HAL with several QEI peripherals defines HAL_QEI_INSTANCES and takes the
+// instance as a third constructor argument. Other HALs have the one QEI and
+// the two argument constructor.
+static Hardware_QEI* createHardwareQEI(bool hasIndex, int modifier, int instance)
+{
+#ifdef HAL_QEI_INSTANCES
+    return ModuleArena::make<Hardware_QEI>(hasIndex, modifier, instance);
+#else
+    (void)instance;
+    return ModuleArena::make<Hardware_QEI>(hasIndex, modifier);
+#endif
+}
+
+// The IndexIrq slots, bound by instance number
+template <uint32_t... Instance>
+struct IndexIrqs
+{
+    static void bind(uint32_t instance, QEI* qei) { ((Instance == instance ? QEI::IndexIrq<Instance>::bind(qei) : (void)0), ...); }
+    static void unbind(uint32_t instance) { ((Instance == instance ? QEI::IndexIrq<Instance>::unbind() : (void)0), ...); }
+};
+
+typedef IndexIrqs<0, 1, 2, 3> QeiIndexIrqs;
+static_assert(QEI::indexIrqs == 4, "QeiIndexIrqs lists every instance");
+
 /***********************************************************************
                 MODULE CONFIGURATION AND CREATION FROM JSON     
 ************************************************************************/
@@ -12,8 +36,22 @@ std::shared_ptr<Module> QEI::create(const JsonObject& config, Remora* instance)
     int pv = config["PV[i]"];
     int dataBit = config["Data Bit"];
     const char* index = config["Enable Index"];
+    int qeiInstance = config["Instance"] | 0;
+    uint32_t counterBits = config["Counter Bits"] | 32;
+
+    // "PV Type": "Int32" sends the count as an exact integer, a float loses counts above 2^24
+    const char* pvType = config["PV Type"];
+    bool intPv = pvType && !strcmp(pvType, "Int32");
 
-    printf("Creating QEI, hardware quadrature encoder interface\n");
+    printf("Creating QEI, hardware quadrature encoder interface %d\n", qeiInstance);
+
+#ifndef HAL_QEI_INSTANCES
+    if (qeiInstance != 0) {
+        printf("  This platform has a single QEI, only Instance 0 is available\n");
+        instance->setStatus(makeRemoraStatus(RemoraErrorSource::MODULE_LOADER, RemoraErrorCode::MODULE_CONFIG_INVALID));
+        return nullptr;
+    }
+#endif
 
     int mod;
 
@@ -29,35 +67,101 @@ std::shared_ptr<Module> QEI::create(const JsonObject& config, Remora* instance)
 		mod = GPIO_NOPULL;
 	}           
 
+    // Optional index timestamp and velocity outputs, checked before the encoder is created
+    bool hasIndexPin = !strcmp(index, "True");
+    bool hasTimestamp = hasIndexPin && config["Index Timestamp PV[i]"].is<int>();
+    bool hasVelocity = config["Velocity PV[i]"].is<int>();
+    int timestampPv = config["Index Timestamp PV[i]"] | 0;
+    int velocityPv = config["Velocity PV[i]"] | 0;
+
+    if (!instance->checkProcessVariable(pv, "PV[i]") ||
+        (hasTimestamp && !instance->checkProcessVariable(timestampPv, "Index Timestamp PV[i]")) ||
+        (hasVelocity && !instance->checkProcessVariable(velocityPv, "Velocity PV[i]"))) {
+        return nullptr;
+    }
+
     volatile float* ptrProcessVariable = &instance->getTxData()->processVariable[pv];
 	volatile uint16_t* ptrInputs = &instance->getTxData()->inputs;
 
-    if (!strcmp(index,"True"))
+    std::unique_ptr<QEI> encoder;
+    if (hasIndexPin)
     {
         printf("  Encoder has index\n");
-        return std::make_unique<QEI>(*ptrProcessVariable, *ptrInputs, dataBit, mod);
+        encoder = std::make_unique<QEI>(*ptrProcessVariable, *ptrInputs, dataBit, mod, qeiInstance);
+
+        // Optional index timestamp, in Base thread ticks. Exported modulo 2^24
+        // so it is exact as a float.
+        // With "Index Timestamp PV Type": "Int32" the timestamp is the full tick
+        // count, the type is independent of the count's "PV Type".
+        // Stamped by the index IRQ where the platform raises QEI::IndexIrq,
+        // otherwise only good to one update period of this thread, see
+        // QEI::setIndexTimestamp()
+        volatile float* ptrIndexTimestamp = nullptr;
+        volatile int32_t* ptrIndexTimestampInt = nullptr;
+        if (hasTimestamp) {
+            const char* timestampType = config["Index Timestamp PV Type"];
+            bool intTimestamp = timestampType && !strcmp(timestampType, "Int32");
+            printf("  Index timestamp at PV[%d]%s\n", timestampPv, intTimestamp ? ", Int32" : "");
+            if (intTimestamp) {
+                ptrIndexTimestampInt = &instance->getTxData()->processVariableInt[timestampPv];
+                instance->getPacketLayout().setIntProcessVariable(timestampPv);
+            } else {
+                ptrIndexTimestamp = &instance->getTxData()->processVariable[timestampPv];
+            }
+        }
+        encoder->setIndexTimestamp(instance->getThread("Base"), ptrIndexTimestamp, ptrIndexTimestampInt, config["ThreadFreq"]);
     }
     else
     {
-        return std::make_unique<QEI>(*ptrProcessVariable, mod);
+        encoder = std::make_unique<QEI>(*ptrProcessVariable, mod, qeiInstance);
+    }
+
+    if (intPv) {
+        encoder->setIntegerOutput(instance->getTxData()->processVariableInt[pv]);
+        instance->getPacketLayout().setIntProcessVariable(pv);
     }
+
+    if (counterBits < 1 || counterBits > 32) counterBits = 32;
+    encoder->setCounterBits(counterBits);
+
+    // Optional velocity estimate, exported in counts per second alongside the count.
+    // A QEI slower than Base has its counter sampled in Base for the estimate,
+    // the edges are timed to a Base tick and the window is Base / Servo ticks.
+    if (hasVelocity) {
+        float minVelocity = config["Min Velocity"] | 1.0f;
+        uint32_t threadFreq = config["ThreadFreq"];
+        pruThread* baseThread = instance->getThread("Base");
+        bool sampled = baseThread && threadFreq < instance->getBaseFreq();
+        printf("  Velocity at PV[%d]%s\n", velocityPv, sampled ? ", sampled in Base" : "");
+        encoder->setVelocityOutput(instance->getTxData()->processVariable[velocityPv], sampled ? instance->getBaseFreq() : threadFreq,
+                                   instance->getServoFreq(), minVelocity);
+        if (sampled) baseThread->registerModule(encoder->createVelocitySampler());
+    }
+
+    return encoder;
 }
 
 /***********************************************************************
 *                METHOD DEFINITIONS                                    *
 ************************************************************************/
 
-QEI::QEI(volatile float &ptrEncoderCount, int modifier) :
-	ptrEncoderCount(&ptrEncoderCount)
+QEI::QEI(volatile float &ptrEncoderCount, int modifier, int instance) :
+	ptrEncoderCount(&ptrEncoderCount),
+    instance(instance)
 {
     hasIndex = false;
-    hardware_qei = new Hardware_QEI(hasIndex, modifier);     
+    hardware_qei = createHardwareQEI(hasIndex, modifier, instance);
+    indexPosition = 0;
+    indexTimestamp = 0;
+    setCounterBits(32);
+    bindTasks<QEI>();
 }
 
-QEI::QEI(volatile float &ptrEncoderCount, volatile uint16_t &ptrData, int bitNumber, int modifier) :
+QEI::QEI(volatile float &ptrEncoderCount, volatile uint16_t &ptrData, int bitNumber, int modifier, int instance) :
 	ptrEncoderCount(&ptrEncoderCount),
     ptrData(&ptrData),
-    bitNumber(bitNumber)
+    bitNumber(bitNumber),
+    instance(instance)
 {
     hasIndex = true;
     indexPulse = 100;                             
@@ -65,19 +169,41 @@ QEI::QEI(volatile float &ptrEncoderCount, volatile uint16_t &ptrData, int bitNum
     pulseCount = 0;                               
     mask = 1 << bitNumber;
 
-    hardware_qei = new Hardware_QEI(hasIndex, modifier);     
+    hardware_qei = createHardwareQEI(hasIndex, modifier, instance);
+    indexPosition = 0;
+    indexTimestamp = 0;
+    setCounterBits(32);
+    bindTasks<QEI>();
+    QeiIndexIrqs::bind(instance, this);
+}
+
+QEI::~QEI()
+{
+    if (hasIndex) QeiIndexIrqs::unbind(instance);
 }
 
 void QEI::update()
 {
-    count = hardware_qei->get();
+    uint32_t raw = hardware_qei->get();
+    extendedCount += counterDelta(lastRaw, raw);
+    lastRaw = raw;
+    count = (int32_t)extendedCount;
+
+    if (ptrVelocity) *(ptrVelocity) = velocitySampled ? velocityEstimator.getVelocity() : velocityEstimator.update(count);
 
     if (hasIndex)                                     // we have an index pin
     {
         // handle index, index pulse and pulse count
         if (hardware_qei->indexDetected && (pulseCount == 0))    // index interrupt occured: rising edge on index pulse
         {
-            *(ptrEncoderCount) = hardware_qei->indexCount;
+            indexPosition = extendedCount + counterDelta(raw, (uint32_t)hardware_qei->indexCount);
+            if (!timebase) indexTimestamp = 0;
+            else if (indexIrqStamped) indexTimestamp = indexIrqTick;
+            else indexTimestamp = timebase->getTickCount() - indexLatency();
+            indexIrqStamped = false;
+            if (ptrIndexTimestampInt) *(ptrIndexTimestampInt) = (int32_t)indexTimestamp;
+            else if (ptrIndexTimestamp) *(ptrIndexTimestamp) = (float)(indexTimestamp & 0xFFFFFF);
+            writeCount(indexPosition);
             pulseCount = indexPulse;        
             *(ptrData) |= mask;                 // set bit in data source high
         }
@@ -89,11 +215,94 @@ void QEI::update()
         else
         {
             *(ptrData) &= ~mask;                // set bit in data source low
-            *(ptrEncoderCount) = count;         // update encoder count
+            writeCount(extendedCount);          // update encoder count
         }
     }
     else
     {
-        *(ptrEncoderCount) = count;             // update encoder count
+        writeCount(extendedCount);              // update encoder count
     }
 }
+
+// Runs in the index IRQ, after the HAL has latched the count
+void QEI::handleIndexInterrupt()
+{
+    if (!timebase) return;
+    indexIrqTick = timebase->getTickCount();
+    indexIrqStamped = true;
+}
+
+void QEI::setVelocityOutput(volatile float &velocity, uint32_t threadFreq, uint32_t windowFreq, float minVelocity)
+{
+    velocityEstimator.configure(threadFreq, windowFreq, minVelocity);
+    velocityEstimator.reset(count);
+    ptrVelocity = &velocity;
+}
+
+// The sampler runs the estimator from here on, in the thread it is registered
+// in, configure the estimator for that thread with setVelocityOutput() first
+std::unique_ptr<QEI::VelocitySampler> QEI::createVelocitySampler()
+{
+    sampleRaw = hardware_qei->get();
+    sampleCount = 0;
+    velocityEstimator.reset(sampleCount);
+    velocitySampled = true;
+    return std::make_unique<VelocitySampler>(*this);
+}
+
+// In the sampler's thread, the counter deltas are taken here as in update()
+void QEI::sampleVelocity()
+{
+    uint32_t raw = hardware_qei->get();
+    sampleCount += counterDelta(sampleRaw, raw);
+    sampleRaw = raw;
+    velocityEstimator.update(sampleCount);
+}
+
+void QEI::changeThreadFreq(int32_t freq)
+{
+    Module::changeThreadFreq(freq);
+    if (!velocitySampled) velocityEstimator.setThreadFreq(freq);
+    updateFreq = freq;
+}
+
+// Width of the hardware counter, restarts the extended count from the counter
+void QEI::setCounterBits(uint32_t bits)
+{
+    counterShift = 32 - bits;
+    lastRaw = hardware_qei->get();
+    extendedCount = counterDelta(0, lastRaw);
+    count = (int32_t)extendedCount;
+}
+
+// The index is timestamped with the tick count of the timebase thread.
+//
+// Where the platform's index IRQ handler calls QEI::IndexIrq<instance>::handle()
+// the stamp is the timebase tick the index fell in.
+//
+// Otherwise the hardware latches the index count but not the time, the index is
+// only seen by the next update(). It fell somewhere in the update period before,
+// so the stamp is taken back half an update period in timebase ticks. That
+// leaves an error of up to half the period of the thread running the QEI, eg
+// +-20 Base ticks at 1 kHz against a 40 kHz Base. Run the QEI in a faster thread
+// for a finer stamp.
+void QEI::setIndexTimestamp(const pruThread* _timebase, volatile float* _ptrIndexTimestamp, volatile int32_t* _ptrIndexTimestampInt, uint32_t _updateFreq)
+{
+    timebase = _timebase;
+    ptrIndexTimestamp = _ptrIndexTimestamp;
+    ptrIndexTimestampInt = _ptrIndexTimestampInt;
+    updateFreq = _updateFreq;
+}
+
+// Mean delay from an index to the update() that sees it, in timebase ticks
+uint32_t QEI::indexLatency() const
+{
+    if (!updateFreq) return 0;
+    return timebase->getFrequency() / (2 * updateFreq);
+}
+
+// Write the count as an exact integer
+void QEI::setIntegerOutput(volatile int32_t &countInt)
+{
+    ptrEncoderCountInt = &countInt;
+}
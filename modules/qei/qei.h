@@ -4,6 +4,9 @@
 #include <string>
 #include "../../remora.h"
 #include "../../modules/module.h"
+#include "../../modules/velocityEstimator.h"
+#include "../../interrupt/staticInterrupt.h"
+#include "../../thread/pruThread.h"
 #include "remora-hal/hardware_qei/hardware_qei.h"
 
 class QEI : public Module
@@ -14,6 +17,7 @@ class QEI : public Module
         Hardware_QEI*           hardware_qei; 
 
 		volatile float*         ptrEncoderCount; 	    // pointer to the data source
+        volatile int32_t*       ptrEncoderCountInt = nullptr;   // the same PV slot as an integer, nullptr for a float PV
 
         volatile uint16_t*      ptrData; 	            // pointer to the data source
 		int                     bitNumber;				// location in the data source
@@ -24,13 +28,84 @@ class QEI : public Module
         int8_t                  indexPulse;
         int8_t                  pulseCount;
 
+        // the hardware counter is extended in software, update() must run at
+        // least once per half counter range
+        uint32_t                counterShift;           // 32 - counter bits, sign extends counter deltas
+        uint32_t                lastRaw;                // counter at the last update
+        int64_t                 extendedCount;          // count extended past the counter width
+        int64_t                 indexPosition;          // extended count at the last index
+        uint32_t                indexTimestamp;         // timebase tick the last index was seen at
+        int                     instance;               // the HAL QEI instance, keys the index IRQ
+        volatile uint32_t       indexIrqTick = 0;       // timebase tick stamped by the index IRQ
+        volatile bool           indexIrqStamped = false;
+        const pruThread*        timebase = nullptr;     // thread counting the timestamp ticks, usually Base
+        uint32_t                updateFreq = 0;         // rate of update(), the index is seen up to a period late
+        volatile float*         ptrIndexTimestamp = nullptr;
+        volatile int32_t*       ptrIndexTimestampInt = nullptr;
+
+        void writeCount(int64_t value)
+        {
+            if (ptrEncoderCountInt) *(ptrEncoderCountInt) = (int32_t)value;     // wraps at 32 bits, exact
+            else *(ptrEncoderCount) = value;
+        }
+
+        uint32_t indexLatency() const;
+
+        int32_t counterDelta(uint32_t from, uint32_t to) const { return (int32_t)((to - from) << counterShift) >> counterShift; }
+
+        VelocityEstimator       velocityEstimator;
+        volatile float*         ptrVelocity = nullptr;  // velocity output, nullptr when not estimated
+        bool                    velocitySampled = false;    // the estimator runs in a VelocitySampler
+        uint32_t                sampleRaw = 0;          // counter at the last sample
+        int32_t                 sampleCount = 0;        // count seen by the sampler, only its changes matter
+
+        void sampleVelocity();
+
 	public:
 
-        QEI(volatile float &ptrEncoderCount, int modifier);                                                // for channel A & B
-        QEI(volatile float &ptrEncoderCount, volatile uint16_t &ptrData, int bitNumber, int modifier);     // For channels A & B, and index
+        QEI(volatile float &ptrEncoderCount, int modifier, int instance);                                                // for channel A & B
+        QEI(volatile float &ptrEncoderCount, volatile uint16_t &ptrData, int bitNumber, int modifier, int instance);     // For channels A & B, and index
+        ~QEI();
 
         static std::shared_ptr<Module> create(const JsonObject& config, Remora* instance);
 		virtual void update(void);
+        void handleIndexInterrupt();
+
+        // The index IRQ of each QEI instance. The platform's index IRQ handler
+        // calls QEI::IndexIrq<instance>::handle() once the HAL has latched the
+        // count, and the index is stamped to the timebase tick it happened in.
+        template <uint32_t Instance>
+        using IndexIrq = ModuleIrq<Instance, QEI, &QEI::handleIndexInterrupt>;
+        static constexpr uint32_t indexIrqs = 4;    // instances with an IndexIrq slot
+
+        // Runs the velocity estimate in the Base thread when the QEI runs in a
+        // slower one, so the counter is sampled and the edges timed every Base
+        // tick rather than once per QEI update
+        class VelocitySampler : public Module
+        {
+            private:
+                QEI& qei;
+
+            public:
+                VelocitySampler(QEI& _qei) : qei(_qei) { bindTasks<VelocitySampler>(); }
+                void update() override { qei.sampleVelocity(); }
+                void changeThreadFreq(int32_t freq) override
+                {
+                    Module::changeThreadFreq(freq);
+                    qei.velocityEstimator.setThreadFreq(freq);
+                }
+        };
+
+        void setVelocityOutput(volatile float &velocity, uint32_t threadFreq, uint32_t windowFreq, float minVelocity);
+        std::unique_ptr<VelocitySampler> createVelocitySampler();
+        void changeThreadFreq(int32_t freq) override;
+        void setCounterBits(uint32_t bits);
+        void setIndexTimestamp(const pruThread* _timebase, volatile float* _ptrIndexTimestamp, volatile int32_t* _ptrIndexTimestampInt, uint32_t _updateFreq);
+        void setIntegerOutput(volatile int32_t &countInt);
+
+        int64_t getExtendedCount() const { return extendedCount; }
+        int64_t getIndexPosition() const { return indexPosition; }
+        uint32_t getIndexTimestamp() const { return indexTimestamp; }
 };
 
 #endif
@@ -14,7 +14,10 @@ std::shared_ptr<Module> ResetPin::create(const JsonObject& config, Remora* insta
 ResetPin::ResetPin(volatile bool* ptrReset, const std::string& portAndPin) :
     ptrReset(ptrReset),
     portAndPin(portAndPin),
-    pin(new Pin(portAndPin, 0)) {}  // Input mode (0x0)
+    pin(ModuleArena::make<Pin>(portAndPin, 0))  // Input mode (0x0)
+{
+    bindTasks<ResetPin>();
+}
 
 void ResetPin::update() {
     *ptrReset = pin->get();
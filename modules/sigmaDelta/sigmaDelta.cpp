@@ -21,10 +21,10 @@ std::shared_ptr<Module> SigmaDelta::create(const JsonObject& config, Remora* ins
     if (config["SD Max"].is<int>()) {
         int SDmax = config["SD Max"];
         printf("Using SD Max=%d\n", SDmax);
-        return std::make_shared<SigmaDelta>(pin, ptrSP, SDmax);
+        return std::make_unique<SigmaDelta>(pin, ptrSP, SDmax);
     } else {
         printf("Using default SD Max\n");
-        return std::make_shared<SigmaDelta>(pin, ptrSP);
+        return std::make_unique<SigmaDelta>(pin, ptrSP);
     }
 }
 
@@ -34,8 +34,11 @@ SigmaDelta::SigmaDelta(const std::string& pin, volatile float* ptrSP) :
     setPoint(0),
     SDaccumulator(0),
     SDdirection(false),
-    SDpin(new Pin(pin, OUTPUT)),
-    ptrSP(ptrSP) {}
+    SDpin(ModuleArena::make<Pin>(pin, OUTPUT)),
+    ptrSP(ptrSP)
+{
+    bindTasks<SigmaDelta>();
+}
 
 SigmaDelta::SigmaDelta(const std::string& pin, volatile float* ptrSP, int SDmax) :
     pin(pin),
@@ -43,8 +46,11 @@ SigmaDelta::SigmaDelta(const std::string& pin, volatile float* ptrSP, int SDmax)
     setPoint(0),
     SDaccumulator(0),
     SDdirection(false),
-    SDpin(new Pin(pin, OUTPUT)),
-    ptrSP(ptrSP) {}
+    SDpin(ModuleArena::make<Pin>(pin, OUTPUT)),
+    ptrSP(ptrSP)
+{
+    bindTasks<SigmaDelta>();
+}
 
 void SigmaDelta::setMaxSD(int SDmax) {
     this->SDmax = CONFINE(SDmax, 0, PID_SD_MAX - 1);
@@ -33,18 +33,47 @@ std::shared_ptr<Module> SoftEncoder::create(const JsonObject& config, Remora* in
 		mod = NONE;
 	}    
     
+    // "PV Type": "Int32" sends the count as an exact integer, a float loses counts above 2^24
+    const char* pvType = config["PV Type"];
+    bool intPv = pvType && !strcmp(pvType, "Int32");
+
+    uint8_t filterTicks = config["Filter Ticks"] | 0;
+    if (filterTicks) printf("  Glitch filter of %d ticks\n", filterTicks);
+
+    bool hasVelocity = config["Velocity PV[i]"].is<int>();
+    int velocityPv = config["Velocity PV[i]"] | 0;
+    if (!instance->checkProcessVariable(pv, "PV[i]") ||
+        (hasVelocity && !instance->checkProcessVariable(velocityPv, "Velocity PV[i]"))) {
+        return nullptr;
+    }
+
     volatile float* ptrProcessVariable = &instance->getTxData()->processVariable[pv];
 	volatile uint16_t* ptrInputs = &instance->getTxData()->inputs;
 
+    std::unique_ptr<SoftEncoder> encoder;
     if (pinI == nullptr || !strcmp(pinI, ""))
     {
-        return std::make_unique<SoftEncoder>(*ptrProcessVariable, pinA, pinB, mod);
+        encoder = std::make_unique<SoftEncoder>(*ptrProcessVariable, pinA, pinB, mod);
     }
     else
     {
         printf("  Encoder has index at pin %s\n", pinI);
-        return std::make_unique<SoftEncoder>(*ptrProcessVariable, *ptrInputs, dataBit, pinA, pinB, pinI, mod);
+        encoder = std::make_unique<SoftEncoder>(*ptrProcessVariable, *ptrInputs, dataBit, pinA, pinB, pinI, mod);
+    }
+    encoder->setFilterTicks(filterTicks);
+    if (intPv) {
+        encoder->setIntegerOutput(instance->getTxData()->processVariableInt[pv]);
+        instance->getPacketLayout().setIntProcessVariable(pv);
     }
+
+    // Optional velocity estimate, exported in counts per second alongside the count
+    if (hasVelocity) {
+        float minVelocity = config["Min Velocity"] | 1.0f;
+        uint32_t threadFreq = config["ThreadFreq"];
+        printf("  Velocity at PV[%d]\n", velocityPv);
+        encoder->setVelocityOutput(instance->getTxData()->processVariable[velocityPv], threadFreq, instance->getServoFreq(), minVelocity);
+    }
+    return encoder;
 }
 
 /***********************************************************************
@@ -53,65 +82,110 @@ std::shared_ptr<Module> SoftEncoder::create(const JsonObject& config, Remora* in
 
 SoftEncoder::SoftEncoder(volatile float &_ptrEncoderCount, std::string _portAndPinChA, std::string _portAndPinChB, int _modifier) :
 	ptrEncoderCount(&_ptrEncoderCount),
+    ptrEncoderCountInt(nullptr),
 	portAndPinChA(_portAndPinChA),
 	portAndPinChB(_portAndPinChB),
-    modifier(_modifier)
+    modifier(_modifier),
+    state(0),
+    pinI(nullptr),
+    portReaderBound(false),
+    filterTicks(0),
+    filterStable(0),
+    filterPending(0),
+    ptrVelocity(nullptr)
 {
-	this->pinA = new Pin(this->portAndPinChA, INPUT, this->modifier);			// create Pin
-    this->pinB = new Pin(this->portAndPinChB, INPUT, this->modifier);			// create Pin
+	this->pinA = ModuleArena::make<Pin>(this->portAndPinChA, INPUT, this->modifier);			// create Pin
+    this->pinB = ModuleArena::make<Pin>(this->portAndPinChB, INPUT, this->modifier);			// create Pin
     this->hasIndex = false;
 	this->count = 0;								                // initialise the count to 0
+    bindTasks<SoftEncoder>();
 }
 
 SoftEncoder::SoftEncoder(volatile float &_ptrEncoderCount, volatile uint16_t &_ptrData, int _bitNumber, std::string _portAndPinChA, std::string _portAndPinChB, std::string _portAndPinIndex, int _modifier) :
 	ptrEncoderCount(&_ptrEncoderCount),
+    ptrEncoderCountInt(nullptr),
     ptrData(&_ptrData),
     bitNumber(_bitNumber),
 	portAndPinChA(_portAndPinChA),
 	portAndPinChB(_portAndPinChB),
     portAndPinIndex(_portAndPinIndex),
     modifier(_modifier),
-    mask(1 << _bitNumber)
+    mask(1 << _bitNumber),
+    state(0),
+    portReaderBound(false),
+    filterTicks(0),
+    filterStable(0),
+    filterPending(0),
+    ptrVelocity(nullptr)
 {
-	this->pinA = new Pin(this->portAndPinChA, INPUT, this->modifier);			// create Pin
-    this->pinB = new Pin(this->portAndPinChB, INPUT, this->modifier);			// create Pin
-    this->pinI = new Pin(this->portAndPinIndex, INPUT, this->modifier);		// create Pin
+	this->pinA = ModuleArena::make<Pin>(this->portAndPinChA, INPUT, this->modifier);			// create Pin
+    this->pinB = ModuleArena::make<Pin>(this->portAndPinChB, INPUT, this->modifier);			// create Pin
+    this->pinI = ModuleArena::make<Pin>(this->portAndPinIndex, INPUT, this->modifier);		// create Pin
     this->hasIndex = true;
     this->indexPulse = (Config::pruBaseFreq / Config::pruServoFreq) * 3;          // output the index pulse for 3 servo thread periods so LinuxCNC sees it
     this->indexCount = 0;
 	this->count = 0;								                // initialise the count to 0
     this->pulseCount = 0;                                           // number of base thread periods to pulse the index output    
+    bindTasks<SoftEncoder>();
+}
+
+// Count change indexed by new B, new A, old B, old A, see the table below
+const int8_t SoftEncoder::quadratureDelta[16] = {
+     0,  1, -1,  2,
+    -1,  0, -2,  1,
+     1, -2,  0, -1,
+     2, -1,  1,  0
+};
+
+// Channel A in bit 0 and channel B in bit 1
+inline uint8_t SoftEncoder::readInputs()
+{
+    if (this->portReaderBound) return this->portReader->get(this->inputA) | (this->portReader->get(this->inputB) << 1);
+    return this->pinA->get() | (this->pinB->get() << 1);
+}
+
+inline bool SoftEncoder::readIndex()
+{
+    if (this->portReaderBound) return this->portReader->get(this->inputI);
+    return this->pinI->get();
+}
+
+inline void SoftEncoder::writeCount(int32_t value)
+{
+    if (this->ptrEncoderCountInt) *(this->ptrEncoderCountInt) = value;
+    else *(this->ptrEncoderCount) = value;
 }
 
 void SoftEncoder::update()
 {
-    uint8_t s = this->state & 3;
-
-    if (this->pinA->get()) s |= 4;
-    if (this->pinB->get()) s |= 8;
-
-    switch (s) {
-		case 0: case 5: case 10: case 15:
-			break;
-		case 1: case 7: case 8: case 14:
-			count++; break;
-		case 2: case 4: case 11: case 13:
-			count--; break;
-		case 3: case 12:
-			count += 2; break;
-		default:
-			count -= 2; break;
-	}
+    uint8_t inputs = readInputs();
 
-	this->state = (s >> 2);
+    if (this->filterTicks)
+    {
+        if (inputs != this->filterPending)
+        {
+            this->filterPending = inputs;                   // restart the filter on any change
+            this->filterStable = 0;
+        }
+        else if (this->filterStable < this->filterTicks)
+        {
+            this->filterStable++;
+        }
+        if (this->filterStable < this->filterTicks) inputs = this->state;     // not held long enough, keep the last inputs
+    }
+
+    this->count += quadratureDelta[(inputs << 2) | this->state];
+	this->state = inputs;
+
+    if (this->ptrVelocity) *(this->ptrVelocity) = this->velocityEstimator.update(this->count);
 
     if (this->hasIndex)                                     // we have an index pin
     {
         // handle index, index pulse and pulse count
-        if (this->pinI->get() && (this->pulseCount == 0))    // rising edge on index pulse
+        if (readIndex() && (this->pulseCount == 0))    // rising edge on index pulse
         {
             this->indexCount = this->count;                 //  capture the encoder count at the index, send this to linuxCNC for one servo period 
-            *(this->ptrEncoderCount) = this->indexCount;
+            writeCount(this->indexCount);
             this->pulseCount = this->indexPulse;        
             *(this->ptrData) |= this->mask;                 // set bit in data source high
         }
@@ -122,16 +196,59 @@ void SoftEncoder::update()
         else
         {
             *(this->ptrData) &= ~this->mask;                // set bit in data source low
-            *(this->ptrEncoderCount) = this->count;         // update encoder count
+            writeCount(this->count);                        // update encoder count
         }
     }
     else
     {
-        *(this->ptrEncoderCount) = this->count;             // update encoder count
+        writeCount(this->count);                            // update encoder count
     }
 }
 
 
+// Bind the encoder inputs to the thread's port snapshot, all the inputs or
+// none. The inputs are released from the previous reader first, so the ports of
+// an unregistered encoder are no longer sampled.
+void SoftEncoder::setPortReader(PortReader* reader)
+{
+    if (this->portReaderBound) {
+        this->portReader->unbind(this->inputA);
+        this->portReader->unbind(this->inputB);
+        if (this->hasIndex) this->portReader->unbind(this->inputI);
+        this->portReaderBound = false;
+    }
+
+    Module::setPortReader(reader);
+    if (!reader) return;
+
+    if (!reader->bind(*this->pinA, this->inputA)) return;
+    if (!reader->bind(*this->pinB, this->inputB)) {
+        reader->unbind(this->inputA);
+        return;
+    }
+    if (this->hasIndex && !reader->bind(*this->pinI, this->inputI)) {
+        reader->unbind(this->inputA);
+        reader->unbind(this->inputB);
+        return;
+    }
+    this->portReaderBound = true;
+}
+
+
+void SoftEncoder::setVelocityOutput(volatile float &velocity, uint32_t threadFreq, uint32_t windowFreq, float minVelocity)
+{
+    this->velocityEstimator.configure(threadFreq, windowFreq, minVelocity);
+    this->velocityEstimator.reset(this->count);
+    this->ptrVelocity = &velocity;
+}
+
+void SoftEncoder::changeThreadFreq(int32_t freq)
+{
+    Module::changeThreadFreq(freq);
+    this->velocityEstimator.setThreadFreq(freq);
+}
+
+
 // credit to https://github.com/PaulStoffregen/Encoder/blob/master/Encoder.h
 
 //                           _______         _______       
@@ -4,6 +4,8 @@
 #include <string>
 #include "../../remora.h"
 #include "../../modules/module.h"
+#include "../../thread/portReader.h"
+#include "../../modules/velocityEstimator.h"
 
 /**
  * @class Software Encoder
@@ -17,6 +19,7 @@ class SoftEncoder : public Module
 {
 	private:
 		volatile float *ptrEncoderCount; 	// pointer to the data source
+        volatile int32_t *ptrEncoderCountInt;   // the same PV slot as an integer, nullptr for a float PV
 
         bool hasIndex;
         volatile uint16_t *ptrData; 	// pointer to the data source
@@ -39,12 +42,37 @@ class SoftEncoder : public Module
         Pin* pinB;      // channel B
         Pin* pinI;      // index    
 
+        // inputs read from the thread's port snapshot when bound
+        PortBit inputA;
+        PortBit inputB;
+        PortBit inputI;
+        bool portReaderBound;
+
+        // glitch filter, a change of the A/B inputs is taken once it has held for filterTicks
+        uint8_t filterTicks;
+        uint8_t filterStable;
+        uint8_t filterPending;
+
+        static const int8_t quadratureDelta[16];
+
+        VelocityEstimator velocityEstimator;
+        volatile float* ptrVelocity;    // velocity output, nullptr when not estimated
+
+        inline uint8_t readInputs();
+        inline bool readIndex();
+        inline void writeCount(int32_t value);
+
 	public:
         SoftEncoder(volatile float &ptrEncoderCount, std::string ChA, std::string ChB, int modifier);
         SoftEncoder(volatile float &ptrEncoderCount, volatile uint16_t &ptrData, int bitNumber, std::string _portAndPinChA, std::string _portAndPinChB, std::string _portAndPinIndex, int modifier);
 
         static std::shared_ptr<Module> create(const JsonObject& config, Remora* instance);
 		virtual void update(void);	// Module default interface
+        void setPortReader(PortReader* reader) override;
+        void setFilterTicks(uint8_t ticks) { filterTicks = ticks; }
+        void setIntegerOutput(volatile int32_t &countInt) { ptrEncoderCountInt = &countInt; }
+        void setVelocityOutput(volatile float &velocity, uint32_t threadFreq, uint32_t windowFreq, float minVelocity);
+        void changeThreadFreq(int32_t freq) override;
 };
 
 #endif
@@ -0,0 +1,159 @@
+#ifndef STATICPIPELINE_H
+#define STATICPIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "module.h"
+
+// Fixed configuration builds (REMORA_STATIC_CONFIG), the module set is known at
+// compile time so the modules are built into static storage rather than created
+// from the JSON config by the ModuleFactory.
+
+// Storage for one module. The module is constructed in place by emplace(), there
+// is no heap allocation for it and it is never destroyed.
+template <typename T>
+class StaticModule
+{
+private:
+    alignas(T) unsigned char storage[sizeof(T)];
+
+public:
+    template <typename... Args>
+    T& emplace(Args&&... args)
+    {
+        return *::new (storage) T(std::forward<Args>(args)...);
+    }
+
+    T& get() { return *std::launder(reinterpret_cast<T*>(storage)); }
+
+    // Non-owning pointer for registering in a thread, the aliasing constructor
+    // with an empty owner does not allocate a control block
+    std::shared_ptr<Module> shared() { return std::shared_ptr<Module>(std::shared_ptr<Module>(), &get()); }
+};
+
+// A fixed list of modules run as a single thread task. The thread makes one
+// indirect call per tick for the whole pipeline, each module's update() and
+// updatePost() is then a qualified call the compiler can inline.
+//
+// Modules with slowUpdate() work are not run by the pipeline, register them in
+// their own StaticModule so the thread's rate groups schedule them.
+template <typename... Modules>
+class StaticPipeline : public Module
+{
+    static_assert(sizeof...(Modules) <= 32, "StaticPipeline holds at most 32 modules");
+
+private:
+    std::tuple<StaticModule<Modules>...> slots;
+    uint32_t updateMask = 0;        // bit per module, set when it has update() work
+    uint32_t postMask = 0;          // and updatePost() work
+
+    template <std::size_t I, typename T>
+    void runUpdate(T& module)
+    {
+        if (updateMask & (1u << I)) module.T::update();
+    }
+
+    template <std::size_t I, typename T>
+    void runUpdatePost(T& module)
+    {
+        if (postMask & (1u << I)) module.T::updatePost();
+    }
+
+    template <std::size_t... I>
+    void updateAll(std::index_sequence<I...>)
+    {
+        (runUpdate<I>(std::get<I>(slots).get()), ...);
+    }
+
+    template <std::size_t... I>
+    void updatePostAll(std::index_sequence<I...>)
+    {
+        (runUpdatePost<I>(std::get<I>(slots).get()), ...);
+    }
+
+    template <std::size_t... I>
+    void setPortWriterAll(PortWriter* writer, std::index_sequence<I...>)
+    {
+        (std::get<I>(slots).get().setPortWriter(writer), ...);
+    }
+
+    template <std::size_t... I>
+    void setPortReaderAll(PortReader* reader, std::index_sequence<I...>)
+    {
+        (std::get<I>(slots).get().setPortReader(reader), ...);
+    }
+
+    template <std::size_t... I>
+    void changeThreadFreqAll(int32_t freq, std::index_sequence<I...>)
+    {
+        (std::get<I>(slots).get().changeThreadFreq(freq), ...);
+    }
+
+    template <std::size_t... I>
+    void changeServoFreqAll(uint32_t freq, std::index_sequence<I...>)
+    {
+        (std::get<I>(slots).get().changeServoFreq(freq), ...);
+    }
+
+public:
+    StaticPipeline()
+    {
+        bindTasks<StaticPipeline>();
+    }
+
+    // Construct the I'th module, every module must be emplaced before the
+    // pipeline is registered in a thread
+    template <std::size_t I, typename... Args>
+    auto& emplace(Args&&... args)
+    {
+        auto& module = std::get<I>(slots).emplace(std::forward<Args>(args)...);
+
+        if (module.getUsesModuleUpdate()) updateMask |= (1u << I);
+        if (module.getUsesModulePost()) postMask |= (1u << I);
+        if (module.getUsesSlowUpdate()) {
+            printf("Warning: static pipeline module %u has slowUpdate work, it is not run by the pipeline\n", (unsigned)I);
+        }
+        return module;
+    }
+
+    template <std::size_t I>
+    auto& get() { return std::get<I>(slots).get(); }
+
+    std::shared_ptr<Module> shared() { return std::shared_ptr<Module>(std::shared_ptr<Module>(), this); }
+
+    void update() override { updateAll(std::index_sequence_for<Modules...>{}); }
+    void updatePost() override { updatePostAll(std::index_sequence_for<Modules...>{}); }
+
+    void changeThreadFreq(int32_t freq) override
+    {
+        Module::changeThreadFreq(freq);
+        changeThreadFreqAll(freq, std::index_sequence_for<Modules...>{});
+    }
+
+    void changeServoFreq(uint32_t freq) override
+    {
+        changeServoFreqAll(freq, std::index_sequence_for<Modules...>{});
+    }
+
+    void setPortWriter(PortWriter* writer) override
+    {
+        Module::setPortWriter(writer);
+        setPortWriterAll(writer, std::index_sequence_for<Modules...>{});
+    }
+
+    void setPortReader(PortReader* reader) override
+    {
+        Module::setPortReader(reader);
+        setPortReaderAll(reader, std::index_sequence_for<Modules...>{});
+    }
+
+    bool getUsesModulePost() const override { return postMask != 0; }
+};
+
+#endif
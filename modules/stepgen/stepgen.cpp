@@ -1,4 +1,7 @@
+#include <cmath>
+
 #include "stepgen.h"
+#include "../ddsScale.h"
 
 
 std::shared_ptr<Module> Stepgen::create(const JsonObject& config, Remora* instance)
@@ -16,12 +19,97 @@ std::shared_ptr<Module> Stepgen::create(const JsonObject& config, Remora* instan
 	    // Configure pointers to data source and feedback location
 	    volatile int32_t* ptrJointFreqCmd = &instance->getRxData()->jointFreqCmd[joint];
 	    volatile int32_t* ptrJointFeedback = &instance->getTxData()->jointFeedback[joint];
-	    volatile uint8_t* ptrJointEnable = &instance->getRxData()->jointEnable;
+	    volatile jointMask_t* ptrJointEnable = &instance->getRxData()->jointEnable;
 
 	    bool usesModulePost = true;		// stepgen uses the thread modulesPost vector
 
+	    // Optional DDS resolution, fractional bits of the step frequency
+	    int resolutionBits = config["DDS Resolution Bits"] | (int)Config::ddsResolutionBits;
+	    if (resolutionBits < 0 || resolutionBits > 24) resolutionBits = Config::ddsResolutionBits;
+
+	    // Optional position mode, the joint command is a position in steps and the
+	    // trajectory to it is planned here within the velocity, acceleration and jerk limits.
+	    // Checked before the stepgen is created, without valid limits a position
+	    // command would be run as a velocity
+	    const char* mode = config["Mode"];
+	    bool positionMode = mode && !strcmp(mode, "Position");
+	    float maxVelocity = config["Max Velocity"] | 0.0f;
+	    float maxAcceleration = config["Max Acceleration"] | 0.0f;
+	    float maxJerk = config["Max Jerk"] | 0.0f;
+	    volatile float* ptrFollowingError = nullptr;
+
+	    if (positionMode) {
+	        if (!(maxVelocity > 0.0f) || !(maxAcceleration > 0.0f) || maxJerk < 0.0f) {
+	            printf("  Position mode needs Max Velocity and Max Acceleration above zero and Max Jerk not negative\n");
+	            instance->setStatus(makeRemoraStatus(RemoraErrorSource::MODULE_LOADER, RemoraErrorCode::MODULE_CONFIG_INVALID));
+	            return nullptr;
+	        }
+
+	        if (config["Following Error PV"].is<int>()) {
+	            int pv = config["Following Error PV"];
+	            if (pv < 0 || pv >= (int)Config::variables) {
+	                printf("  Following Error PV %d is out of range, it must be below %lu\n", pv, (unsigned long)Config::variables);
+	                instance->setStatus(makeRemoraStatus(RemoraErrorSource::MODULE_LOADER, RemoraErrorCode::MODULE_CONFIG_INVALID));
+	                return nullptr;
+	            }
+	            ptrFollowingError = &instance->getTxData()->processVariable[pv];
+	        }
+	    }
+
 	    // Create the step generator and register it in the thread
-	    return std::make_unique<Stepgen>(threadFreq, joint, enable, step, dir, Config::stepBit, *ptrJointFreqCmd, *ptrJointFeedback, *ptrJointEnable, usesModulePost);
+	    auto stepgen = std::make_unique<Stepgen>(threadFreq, joint, enable, step, dir, resolutionBits, *ptrJointFreqCmd, *ptrJointFeedback, *ptrJointEnable, usesModulePost);
+
+	    if (positionMode) {
+	        printf("  Position mode: max velocity %.0f, max acceleration %.0f, max jerk %.0f\n", maxVelocity, maxAcceleration, maxJerk);
+	        stepgen->setPositionMode(maxVelocity, maxAcceleration, maxJerk, ptrFollowingError);
+	    }
+
+	    // Optional sub-tick step timing, the step pulses come from a timer output
+	    // scheduled at the DDS phase of the step rather than on the thread tick
+	    const char* subTick = config["Sub Tick Steps"];
+	    if (subTick && !strcmp(subTick, "True")) {
+	        uint32_t pulseWidthNs = config["Step Pulse Width"] | 2000;
+	        std::unique_ptr<PulseOutput> pulseOutput = instance->createPulseOutput(step);
+	        if (pulseOutput) {
+	            printf("  Sub-tick step timing, pulse width %lu ns\n", (unsigned long)pulseWidthNs);
+	            stepgen->setPulseOutput(std::move(pulseOutput), pulseWidthNs);
+	        } else {
+	            printf("  No timer pulse output on %s, steps are timed by the thread\n", step);
+	        }
+	    }
+
+	    // Optional interpolation of velocity commands across the servo period
+	    const char* interpolation = config["Interpolation"];
+	    if (interpolation) {
+	        if (!strcmp(interpolation, "Linear")) {
+	            stepgen->setInterpolation(INTERPOLATE_LINEAR, instance->getServoFreq());
+	        } else if (!strcmp(interpolation, "S-Curve")) {
+	            stepgen->setInterpolation(INTERPOLATE_SCURVE, instance->getServoFreq());
+	        } else {
+	            printf("  Unknown interpolation %s, commands are not interpolated\n", interpolation);
+	        }
+	    }
+
+	    // Optional fractional velocity command, the command is the step frequency << fraction bits.
+	    // Without it the command is whole Hz and only the interpolation and position
+	    // mode use the DDS resolution below 1 Hz
+	    if (config["Command Fraction Bits"].is<int>() && !positionMode) {
+	        int fractionBits = config["Command Fraction Bits"];
+	        if (fractionBits < 0 || fractionBits > 12) fractionBits = 0;
+	        if (fractionBits > resolutionBits) fractionBits = resolutionBits;
+	        printf("  Velocity command with %d fraction bits\n", fractionBits);
+	        stepgen->setCommandFractionBits(fractionBits);
+	    }
+
+	    // Optional fractional feedback, the feedback is the position in steps << fraction bits
+	    if (config["Feedback Fraction Bits"].is<int>()) {
+	        int fractionBits = config["Feedback Fraction Bits"];
+	        if (fractionBits < 0 || fractionBits > 12) fractionBits = 0;
+	        printf("  Feedback with %d fraction bits\n", fractionBits);
+	        stepgen->setFeedbackFractionBits(fractionBits);
+	    }
+
+	    return stepgen;
 	}
 
 /**
@@ -35,32 +123,61 @@ std::shared_ptr<Module> Stepgen::create(const JsonObject& config, Remora* instan
  * @param _enable The name of the pin used to enable the step generator.
  * @param _step The name of the pin used for stepping.
  * @param _direction The name of the pin used for direction.
- * @param _stepBit The number of bits used for the step value.
+ * @param _resolutionBits The number of fractional bits in the DDS add value.
  * @param _ptrFrequencyCommand A reference to the frequency command data for the joint.
  * @param _ptrFeedback A reference to the feedback data for the joint.
  * @param _ptrJointEnable A reference to the joint enable data.
  */
-Stepgen::Stepgen(int32_t _threadFreq, int _jointNumber, const char* _enable, const char* _step, const char* _direction, int _stepBit, volatile int32_t& _ptrFrequencyCommand, volatile int32_t& _ptrFeedback,  volatile uint8_t& _ptrJointEnable, bool _usesModulePost)
+Stepgen::Stepgen(int32_t _threadFreq, int _jointNumber, const char* _enable, const char* _step, const char* _direction, int _resolutionBits, volatile int32_t& _ptrFrequencyCommand, volatile int32_t& _ptrFeedback,  volatile jointMask_t& _ptrJointEnable, bool _usesModulePost)
     : jointNumber(_jointNumber),
       enable(_enable),
       step(_step),
       direction(_direction),
-      stepBit(_stepBit),
+      resolutionBits(_resolutionBits),
+      commandShift(_resolutionBits),
       ptrFrequencyCommand(&_ptrFrequencyCommand),
       ptrFeedback(&_ptrFeedback),
       ptrJointEnable(&_ptrJointEnable),
 	  enablePin(_enable, OUTPUT),
       stepPin(_step, OUTPUT),
       directionPin(_direction, OUTPUT),
+      enableOutput{},
+      stepOutput{},
+      directionOutput{},
+      portWriterBound(false),
+      enableState(-1),
+      positionMode(false),
+      maxVelocity(0.0f),
+      maxAcceleration(0.0f),
+      maxJerk(0.0f),
+      velocity(0.0f),
+      acceleration(0.0f),
+      tickPeriod(1.0f / _threadFreq),
+      ptrFollowingError(nullptr),
+      interpolation(INTERPOLATE_NONE),
+      servoFreq(0),
+      rampTicks(0),
+      rampTick(0),
+      rampStart(0),
+      rampDelta(0),
+      rampValue(0),
+      feedbackFractionBits(0),
+      fractionScale(0),
+      pulseOutput(nullptr),
+      pulseWidthNs(0),
+      pulseWidth(0),
+      periodCounts(0),
       rawCount(0),
       DDSaccumulator(0),
-      frequencyScale(1.0f * (1 << _stepBit) / _threadFreq),  // Frequency scaling without unnecessary cast
-      mask(1 << _jointNumber),  // Mask for checking the joint number
+      stepUnits((int64_t)_threadFreq << _resolutionBits),
+      mask(1u << _jointNumber),  // Mask for checking the joint number
       isEnabled(false),
       isForward(false),
       isStepping(false)
 {
+	threadFreq = _threadFreq;
 	usesModulePost = _usesModulePost;
+	bindTasks<Stepgen>();
 }
 
 /**
@@ -107,23 +224,44 @@ void Stepgen::makePulses()
     isEnabled = ((*(ptrJointEnable) & mask) != 0);
     if (!isEnabled)
     {
-        enablePin.set(true);  	// Disable the driver if not enabled
+        writeEnable(true);  	// Disable the driver if not enabled
+        velocity = 0.0f;  		// a position mode move restarts from rest
+        acceleration = 0.0f;
+        rampStart = rampDelta = rampValue = 0;	// and an interpolated one from zero
         return;  				// Exit early if the generator is disabled
     }
 
-    enablePin.set(false); 		// Enable the driver
+    writeEnable(false); 		// Enable the driver
+
+    // Get the current frequency command, in position mode the frequency comes
+    // from the trajectory planner
+    if (positionMode) {
+        DDSaddValue = (int64_t)(planVelocity() * (float)(1UL << resolutionBits));
+    } else {
+        frequencyCommand = *ptrFrequencyCommand;
+        DDSaddValue = (int64_t)frequencyCommand * ((int64_t)1 << commandShift);
+    }
 
-    // Get the current frequency command and scale it using the frequency scale
-    frequencyCommand = *ptrFrequencyCommand;
-    DDSaddValue = frequencyCommand * frequencyScale;
+    // At most one step per tick
+    if (DDSaddValue >= stepUnits) DDSaddValue = stepUnits - 1;
+    else if (DDSaddValue <= -stepUnits) DDSaddValue = 1 - stepUnits;
 
-    // Save the current DDS accumulator value and update it
-    int32_t stepNow = DDSaccumulator;
+    if (interpolation != INTERPOLATE_NONE && !positionMode) interpolate();
+
+    // The accumulator counts stepUnits per step, each time it wraps a step is made.
+    // This is exact integer arithmetic, the steps over any run are the commanded
+    // frequency times the elapsed ticks with no drift.
+    int64_t previous = DDSaccumulator;
     DDSaccumulator += DDSaddValue;
 
-    // Check for changes in the low half of the DDS accumulator
-    stepNow ^= DDSaccumulator;
-    stepNow &= (1L << stepBit);  // Check for the step bit
+    bool stepNow = false;
+    if (DDSaccumulator >= stepUnits) {
+        DDSaccumulator -= stepUnits;
+        stepNow = true;
+    } else if (DDSaccumulator < 0) {
+        DDSaccumulator += stepUnits;
+        stepNow = true;
+    }
 
     // Determine direction based on the sign of DDSaddValue
     isForward = DDSaddValue > 0;
@@ -131,12 +269,135 @@ void Stepgen::makePulses()
     // If a step is to be made, set the direction and step pins accordingly
     if (stepNow)
     {
-        directionPin.set(isForward);  // Set direction pin
-        stepPin.set(true);  // Set the step pin
+        writeOutput(directionPin, directionOutput, isForward);  // Set direction pin
+        if (pulseOutput) {
+            scheduleStep(previous);  // Time the step pulse within the tick
+        } else {
+            writeOutput(stepPin, stepOutput, true);  // Set the step pin
+        }
         rawCount += (isForward ? 1 : -1);  // Update rawCount based on direction
-        *ptrFeedback = rawCount;  // Update the feedback with the raw count
+        if (!feedbackFractionBits) *ptrFeedback = rawCount;  // Update the feedback with the raw count
         isStepping = true;  // Indicate that stepping is occurring
     }
+
+    // With fractional feedback the position moves every tick
+    if (feedbackFractionBits) writeFractionalFeedback();
+}
+
+/**
+ * @brief Spreads a change of velocity command across the servo period.
+ * 
+ * A change of command starts a ramp from the current add value to the new
+ * one, over the base ticks in one servo period. The ramp weight is linear or
+ * an S-curve (smoothstep, 3s^2 - 2s^3) in Q15, so the step rate changes
+ * gradually rather than jumping once per packet.
+ */
+void Stepgen::interpolate()
+{
+    int64_t target = DDSaddValue;
+
+    if (target != rampStart + rampDelta) {
+        rampStart = rampValue;
+        rampDelta = target - rampStart;
+        rampTick = 0;
+    }
+
+    if (rampTick >= rampTicks) {
+        rampValue = target;
+        return;
+    }
+    rampTick++;
+
+    uint32_t weight = (rampTick << 15) / rampTicks;
+    if (interpolation == INTERPOLATE_SCURVE) {
+        uint32_t squared = (weight * weight) >> 15;
+        weight = (squared * (3 * 32768 - 2 * weight)) >> 15;
+    }
+
+    rampValue = rampStart + ((rampDelta * weight) >> 15);
+    DDSaddValue = rampValue;
+}
+
+/**
+ * @brief Sets the interpolation of velocity commands.
+ * 
+ * @param _interpolation INTERPOLATE_NONE, INTERPOLATE_LINEAR or INTERPOLATE_SCURVE.
+ * @param _servoFreq The servo thread frequency, the rate new commands arrive.
+ */
+void Stepgen::setInterpolation(StepgenInterpolation _interpolation, uint32_t _servoFreq)
+{
+    interpolation = _interpolation;
+    servoFreq = _servoFreq;
+    scaleInterpolation();
+}
+
+/**
+ * @brief Rescales the interpolation to a new servo frequency.
+ * 
+ * Called from the thread ISR when the servo thread is retimed, so a ramp keeps
+ * spanning one servo period.
+ * 
+ * @param _servoFreq The new servo thread frequency.
+ */
+void Stepgen::changeServoFreq(uint32_t _servoFreq)
+{
+    servoFreq = _servoFreq;
+    scaleInterpolation();
+}
+
+void Stepgen::scaleInterpolation()
+{
+    rampTicks = servoFreq ? threadFreq / servoFreq : 0;
+    if (rampTicks < 1) rampTicks = 1;
+    if (rampTick > rampTicks) rampTick = rampTicks;
+}
+
+/**
+ * @brief Writes the position with fractional step resolution to the feedback.
+ * 
+ * The fraction is the accumulator phase, the count and fraction are combined
+ * into one 32 bit store so the host never sees one without the other.
+ */
+void Stepgen::writeFractionalFeedback()
+{
+    uint32_t fraction = (uint32_t)(((uint64_t)DDSaccumulator * fractionScale) >> fractionShift);
+    if (fraction >> feedbackFractionBits) fraction = (1u << feedbackFractionBits) - 1;
+    *ptrFeedback = (int32_t)(((uint32_t)rawCount << feedbackFractionBits) + fraction);
+}
+
+/**
+ * @brief Sets the number of fraction bits in the position feedback.
+ * 
+ * The feedback becomes the position in steps << fraction bits, the host
+ * divides by 2^fractionBits. 0 restores the plain step count.
+ * 
+ * @param _fractionBits The number of fraction bits, 0 to 12.
+ */
+void Stepgen::setFeedbackFractionBits(uint32_t _fractionBits)
+{
+    feedbackFractionBits = _fractionBits;
+    scaleFeedbackFraction();
+    if (!feedbackFractionBits) *ptrFeedback = rawCount;
+}
+
+/**
+ * @brief Sets the number of fraction bits in the velocity command.
+ * 
+ * The command becomes the step frequency << fraction bits, the host
+ * multiplies by 2^fractionBits, so a velocity command resolves below 1 Hz.
+ * 0 restores a command in whole Hz.
+ * 
+ * @param _fractionBits The number of fraction bits, 0 to 12 and at most the DDS resolution.
+ */
+void Stepgen::setCommandFractionBits(uint32_t _fractionBits)
+{
+    commandShift = resolutionBits - _fractionBits;
+}
+
+void Stepgen::scaleFeedbackFraction()
+{
+    // rounded up so exact phases are not truncated, the result is clamped below one step when used
+    fractionScale = feedbackFractionBits ? (((uint64_t)1 << (feedbackFractionBits + fractionShift)) + stepUnits - 1) / stepUnits : 0;
 }
 
 /**
@@ -146,10 +407,245 @@ void Stepgen::makePulses()
  */
 void Stepgen::stopPulses()
 {
-    stepPin.set(false);  // Reset step pin to low
+    writeOutput(stepPin, stepOutput, false);  // Reset step pin to low
     isStepping = false;  // Indicate that stepping has stopped
 }
 
+/**
+ * @brief Schedules the step on the pulse output at its sub-tick time.
+ * 
+ * The step falls where the accumulator wraps, the fraction of the add value
+ * needed to reach the wrap is the fraction of the tick at which the step falls.
+ * The pulse is scheduled in the next tick period, one full period after its
+ * place in this tick. The direction pin is written and flushed in this tick,
+ * so it is always set up at least the rest of the tick ahead of the step edge,
+ * however early in the tick the step falls. The edges are one tick late but
+ * keep the spacing of the commanded frequency to within a timer count.
+ * 
+ * @param previous The accumulator value at the start of the tick.
+ */
+void Stepgen::scheduleStep(int64_t previous)
+{
+    uint64_t add, toBoundary;
+
+    if (DDSaddValue > 0) {
+        add = DDSaddValue;
+        toBoundary = stepUnits - previous;
+    } else {
+        add = -DDSaddValue;
+        toBoundary = previous + 1;
+    }
+    if (toBoundary > add) toBoundary = add;
+
+    uint32_t delay = periodCounts + (uint32_t)((toBoundary * periodCounts) / add);
+    pulseOutput->schedulePulse(delay, pulseWidth);
+}
+
+/**
+ * @brief Drives the step pin from a timer pulse output.
+ * 
+ * The steps are then timed to the timer clock rather than the thread tick and
+ * the pulse output ends the pulse, updatePost() is no longer needed.
+ * 
+ * @param _pulseOutput The pulse output driving the step pin.
+ * @param _pulseWidthNs The step pulse width (ns).
+ */
+void Stepgen::setPulseOutput(std::unique_ptr<PulseOutput> _pulseOutput, uint32_t _pulseWidthNs)
+{
+    pulseOutput = std::move(_pulseOutput);
+    pulseWidthNs = _pulseWidthNs;
+    usesModulePost = false;
+    scalePulseOutput();
+}
+
+void Stepgen::scalePulseOutput()
+{
+    if (!pulseOutput) return;
+    uint32_t clock = pulseOutput->getClockFrequency();
+    periodCounts = clock / threadFreq;
+    pulseWidth = (uint32_t)(((uint64_t)pulseWidthNs * clock) / 1000000000ULL);
+    if (pulseWidth == 0) pulseWidth = 1;
+}
+
+/**
+ * @brief Plans the next tick of a position mode move.
+ * 
+ * The velocity is limited to the speed the joint can still stop from in the
+ * remaining distance, sqrt(2 * a * d), and to the maximum velocity. It moves
+ * toward that speed within the acceleration limit and, when a jerk limit is
+ * set, the acceleration moves within the jerk limit. A late or lost command
+ * leaves the target in place, the joint then settles on it.
+ * 
+ * @return The velocity for this tick in steps per second.
+ */
+float Stepgen::planVelocity()
+{
+    // positions in accumulator units, the DDS position is the step count plus the accumulator phase
+    int64_t target = (int64_t)(*ptrFrequencyCommand) * stepUnits;
+    int64_t position = (int64_t)rawCount * stepUnits + DDSaccumulator;
+    float error = (float)(target - position) / (float)stepUnits;
+
+    if (ptrFollowingError) *ptrFollowingError = error;
+
+    float distance = fabsf(error);
+    float direction = (error < 0.0f) ? -1.0f : 1.0f;
+
+    if (maxJerk <= 0.0f) {
+        // the fastest speed that can still stop in the remaining distance
+        float targetVelocity = fminf(sqrtf(2.0f * maxAcceleration * distance), maxVelocity) * direction;
+        float velocityStep = maxAcceleration * tickPeriod;
+        velocity += fmaxf(-velocityStep, fminf(velocityStep, targetVelocity - velocity));
+        return velocity;
+    }
+
+    // Jerk limited, work in the direction of the error. Decelerate once the
+    // S-curve stopping distance from the current velocity and acceleration
+    // reaches the remaining distance, otherwise head for the maximum velocity.
+    float v = velocity * direction;
+    float a = acceleration * direction;
+    float targetVelocity = (stoppingDistance(v, a) >= distance) ? 0.0f : maxVelocity;
+
+    // acceleration that can still be ramped back to zero as the velocity reaches its target
+    float change = targetVelocity - v;
+    float targetAcceleration = fminf(sqrtf(2.0f * maxJerk * fabsf(change)), maxAcceleration);
+    if (change < 0.0f) targetAcceleration = -targetAcceleration;
+
+    float accelerationStep = maxJerk * tickPeriod;
+    a += fmaxf(-accelerationStep, fminf(accelerationStep, targetAcceleration - a));
+    v += a * tickPeriod;
+
+    acceleration = a * direction;
+    velocity = v * direction;
+    return velocity;
+}
+
+/**
+ * @brief Distance to stop from a velocity and acceleration under the jerk limit.
+ * 
+ * The acceleration is first ramped to zero, then the joint stops with an
+ * S-curve: a triangular deceleration below A^2/J, trapezoidal above.
+ * 
+ * @param v The velocity toward the target (steps/s).
+ * @param a The acceleration toward the target (steps/s^2).
+ * @return The stopping distance in steps.
+ */
+float Stepgen::stoppingDistance(float v, float a) const
+{
+    float distance = 0.0f;
+    if (a > 0.0f) {
+        float rampTime = a / maxJerk;
+        distance = (v + a * rampTime / 3.0f) * rampTime;
+        v += 0.5f * a * rampTime;
+    }
+    if (v <= 0.0f) return distance;
+
+    float rampVelocity = maxAcceleration * maxAcceleration / maxJerk;
+    if (v < rampVelocity) {
+        return distance + v * sqrtf(v / maxJerk);
+    }
+    return distance + 0.5f * v * (v / maxAcceleration + maxAcceleration / maxJerk);
+}
+
+/**
+ * @brief Switches the Stepgen to position mode.
+ * 
+ * The joint command is then a position in steps rather than a frequency.
+ * 
+ * @param _maxVelocity The maximum velocity in steps per second.
+ * @param _maxAcceleration The maximum acceleration in steps per second^2.
+ * @param _maxJerk The maximum jerk in steps per second^3, 0 for no jerk limit.
+ * @param _ptrFollowingError Where to write the following error in steps, or nullptr.
+ */
+void Stepgen::setPositionMode(float _maxVelocity, float _maxAcceleration, float _maxJerk, volatile float* _ptrFollowingError)
+{
+    positionMode = true;
+    maxVelocity = _maxVelocity;
+    maxAcceleration = _maxAcceleration;
+    maxJerk = _maxJerk;
+    ptrFollowingError = _ptrFollowingError;
+    velocity = 0.0f;
+    acceleration = 0.0f;
+}
+
+/**
+ * @brief Stages an output in the thread's PortWriter, or writes it directly.
+ * 
+ * Staged writes are flushed by the thread as one write per port after the
+ * update and post tasks.
+ * 
+ * @param pin The pin to write when no PortWriter is bound.
+ * @param output The pin's position in the PortWriter.
+ * @param value The output state.
+ */
+void Stepgen::writeOutput(Pin& pin, const PortBit& output, bool value)
+{
+    if (portWriterBound) {
+        portWriter->stage(output, value);
+    } else {
+        pin.set(value);
+    }
+}
+
+/**
+ * @brief Writes the enable pin, only when its state changes.
+ * 
+ * @param value The enable pin state (true disables the driver).
+ */
+void Stepgen::writeEnable(bool value)
+{
+    if (enableState == (int8_t)value) return;
+    enableState = value;
+    writeOutput(enablePin, enableOutput, value);
+}
+
+/**
+ * @brief Binds the step, direction and enable pins to the thread's PortWriter.
+ * 
+ * Called when the Stepgen is registered in or removed from a thread. If any
+ * pin cannot be bound the pins are written directly.
+ * 
+ * @param writer The thread's PortWriter, or nullptr.
+ */
+void Stepgen::setPortWriter(PortWriter* writer)
+{
+    portWriterBound = false;
+    Module::setPortWriter(writer);
+
+    if (writer) {
+        portWriterBound = writer->bind(enablePin, enableOutput) &&
+                          writer->bind(stepPin, stepOutput) &&
+                          writer->bind(directionPin, directionOutput);
+    }
+}
+
+/**
+ * @brief Rescales the frequency command to a new thread frequency.
+ * 
+ * Called from the thread ISR when the base thread is retimed, so the
+ * DDS keeps producing the commanded step rate.
+ * 
+ * @param _threadFreq The new thread frequency.
+ */
+void Stepgen::changeThreadFreq(int32_t _threadFreq)
+{
+    Module::changeThreadFreq(_threadFreq);
+    // keep the accumulator phase through the change of units
+    int64_t units = (int64_t)_threadFreq << resolutionBits;
+    DDSaccumulator = scaleDDSUnits(DDSaccumulator, units, stepUnits);
+    stepUnits = units;
+
+    // the ramp is in frequency units and needs no rescale, but may be past the
+    // new one step per tick limit, so restart it from the clamped current value
+    if (rampValue >= stepUnits) rampValue = stepUnits - 1;
+    else if (rampValue <= -stepUnits) rampValue = 1 - stepUnits;
+    rampStart = rampValue;
+    rampDelta = 0;
+    scaleFeedbackFraction();
+    scaleInterpolation();
+    tickPeriod = 1.0f / _threadFreq;
+    scalePulseOutput();
+}
+
 /**
  * @brief Enables or disables the Stepgen.
  * 
@@ -5,8 +5,18 @@
 
 #include "../../remora.h"
 #include "../../modules/module.h"
+#include "../../thread/portWriter.h"
+#include "../../thread/pulseOutput.h"
 #include "../../../remora-hal/pin/pin.h"
 
+// Interpolation of the velocity command between servo packets
+enum StepgenInterpolation : uint8_t
+{
+	INTERPOLATE_NONE = 0,
+	INTERPOLATE_LINEAR,
+	INTERPOLATE_SCURVE
+};
+
 /**
  * @class Stepgen
  * @brief Stepper motor control module for handling pulse generation.
@@ -23,21 +33,47 @@ private:
 	const char* enable;            			/**< Pin for enabling the stepper motor */
 	const char* step;              			/**< Pin for generating step pulses */
 	const char* direction;         			/**< Pin for setting direction */
-	int32_t stepBit;               			/**< Position in the DDS accumulator that triggers a step pulse */
+	uint32_t resolutionBits;       			/**< Fractional bits of the DDS add value */
+	uint32_t commandShift;         			/**< Velocity command to add value, resolutionBits - command fraction bits */
 
 	volatile int32_t* ptrFrequencyCommand; 	/**< Pointer to the frequency command data */
 	volatile int32_t* ptrFeedback; 			/**< Pointer for feedback data */
-	volatile uint8_t* ptrJointEnable; 		/**< Pointer for joint enable data */
+	volatile jointMask_t* ptrJointEnable; 	/**< Pointer for joint enable data */
 
 	Pin enablePin, stepPin, directionPin; 	/**< Pins for controlling the motor's enable, step, and direction */
+	PortBit enableOutput, stepOutput, directionOutput; /**< The pins' positions in the thread's PortWriter */
+	bool portWriterBound;          			/**< Flag indicating the pins are staged through the PortWriter */
+	int8_t enableState;            			/**< Last state written to the enable pin, -1 until the first write */
+	bool positionMode;             			/**< Flag indicating the joint command is a position */
+	float maxVelocity;             			/**< Position mode velocity limit (steps/s) */
+	float maxAcceleration;         			/**< Position mode acceleration limit (steps/s^2) */
+	float maxJerk;                 			/**< Position mode jerk limit (steps/s^3), 0 = unlimited */
+	float velocity;                			/**< Position mode planned velocity (steps/s) */
+	float acceleration;            			/**< Position mode planned acceleration (steps/s^2) */
+	float tickPeriod;              			/**< Thread period (s) */
+	volatile float* ptrFollowingError;		/**< Pointer for following error feedback, may be null */
+	StepgenInterpolation interpolation;		/**< Velocity command interpolation */
+	uint32_t servoFreq;            			/**< Rate new commands arrive (Hz) */
+	uint32_t rampTicks;            			/**< Ticks to ramp over, thread ticks per servo period */
+	uint32_t rampTick;             			/**< Position in the ramp */
+	int64_t rampStart;             			/**< Add value at the start of the ramp */
+	int64_t rampDelta;             			/**< Change of add value over the ramp */
+	int64_t rampValue;             			/**< Interpolated add value */
+	static constexpr uint32_t fractionShift = 48;	/**< Fixed point shift of fractionScale */
+	uint32_t feedbackFractionBits;  		/**< Fraction bits in the position feedback, 0 for a plain step count */
+	uint64_t fractionScale;        			/**< Accumulator phase to feedback fraction, fixed point */
+	std::unique_ptr<PulseOutput> pulseOutput;	/**< Timer pulse output for sub-tick step timing, may be null */
+	uint32_t pulseWidthNs;         			/**< Step pulse width for the pulse output (ns) */
+	uint32_t pulseWidth;           			/**< Step pulse width in pulse output counts */
+	uint32_t periodCounts;         			/**< Thread period in pulse output counts */
 
 	int32_t rawCount;              			/**< The current position raw count (not used yet) */
-	int32_t DDSaccumulator;        			/**< The Direct Digital Synthesis (DDS) accumulator */
-	float frequencyScale;          			/**< Frequency scale factor */
+	int64_t DDSaccumulator;        			/**< The Direct Digital Synthesis (DDS) accumulator, 0 to stepUnits - 1 */
+	int64_t stepUnits;             			/**< Accumulator units per step, threadFreq << resolutionBits */
 	int32_t frequencyCommand;      			/**< The frequency command from LinuxCNC */
-	int32_t DDSaddValue;           			/**< Value added to the DDS accumulator */
+	int64_t DDSaddValue;           			/**< Value added to the DDS accumulator, the step frequency << resolutionBits */
 
-	int mask;                      			/**< Mask for enabling the step generator for specific joint */
+	uint32_t mask;                 			/**< Mask for enabling the step generator for specific joint */
 
 	bool isEnabled;                			/**< Flag indicating whether the step generator is enabled */
 	bool isForward;                			/**< Current direction (forward or backward) */
@@ -45,16 +81,34 @@ private:
 
 	void makePulses();             			/**< Generates step pulses */
 	void stopPulses();             			/**< Stops the pulse generation */
+	float planVelocity();          			/**< Plans the position mode velocity for this tick */
+	float stoppingDistance(float v, float a) const;	/**< Jerk limited stopping distance */
+	void scheduleStep(int64_t previous);   	/**< Schedules a step on the pulse output at its sub-tick time */
+	void scalePulseOutput();       			/**< Converts the pulse timing to pulse output counts */
+	void interpolate();            			/**< Interpolates the add value toward the command */
+	void scaleInterpolation();     			/**< Converts the servo period to thread ticks */
+	void writeFractionalFeedback();			/**< Writes the position with fractional step resolution */
+	void scaleFeedbackFraction();  			/**< Converts the accumulator phase to feedback fraction units */
+	void writeOutput(Pin& pin, const PortBit& output, bool value);	/**< Stages or writes an output pin */
+	void writeEnable(bool value);  			/**< Writes the enable pin when it changes */
 
 public:
 
-	Stepgen(int32_t _threadFreq, int _jointNumber, const char* _enable, const char* _step, const char* _direction, int _stepBit, volatile int32_t &_ptrFrequencyCommand, volatile int32_t &_ptrFeedback, volatile uint8_t &_ptrJointEnable, bool _usesModulePost);
+	Stepgen(int32_t _threadFreq, int _jointNumber, const char* _enable, const char* _step, const char* _direction, int _resolutionBits, volatile int32_t &_ptrFrequencyCommand, volatile int32_t &_ptrFeedback, volatile jointMask_t &_ptrJointEnable, bool _usesModulePost);
 	static std::shared_ptr<Module> create(const JsonObject& config, Remora* instance);
 
 	void update(void) override;
 	void updatePost(void) override;
 	void slowUpdate(void) override;
+	void changeThreadFreq(int32_t _threadFreq) override;
+	void changeServoFreq(uint32_t _servoFreq) override;
+	void setPortWriter(PortWriter* writer) override;
 	void setEnabled(bool state);
+	void setInterpolation(StepgenInterpolation _interpolation, uint32_t _servoFreq);
+	void setFeedbackFractionBits(uint32_t _fractionBits);
+	void setCommandFractionBits(uint32_t _fractionBits);
+	void setPulseOutput(std::unique_ptr<PulseOutput> _pulseOutput, uint32_t _pulseWidthNs);
+	void setPositionMode(float _maxVelocity, float _maxAcceleration, float _maxJerk, volatile float* _ptrFollowingError);
 
 };
 
@@ -0,0 +1,281 @@
+#include "stepgenBank.h"
+#include "../ddsScale.h"
+
+
+std::shared_ptr<Module> StepgenBank::create(const JsonObject& config, Remora* instance)
+{
+    const char* comment = config["Comment"];
+    uint32_t threadFreq = config["ThreadFreq"];
+
+    printf("%s\n", comment);
+
+    JsonArray joints = config["Joints"];
+    if (joints.isNull()) {
+        printf("Error: Stepgen Bank has no \"Joints\"\n");
+        return nullptr;
+    }
+
+    int resolutionBits = config["DDS Resolution Bits"] | (int)Config::ddsResolutionBits;
+    if (resolutionBits < 0 || resolutionBits > 24) resolutionBits = Config::ddsResolutionBits;
+
+    auto bank = std::make_unique<StepgenBank>(threadFreq, resolutionBits, *instance->getRxData(), *instance->getTxData());
+
+    for (JsonObject joint : joints) {
+        int jointNumber = joint["Joint Number"];
+        const char* enable = joint["Enable Pin"];
+        const char* step = joint["Step Pin"];
+        const char* dir = joint["Direction Pin"];
+
+        printf("  Joint %d\n", jointNumber);
+        if (!bank->addJoint(jointNumber, enable, step, dir)) {
+            printf("Error: Stepgen Bank joint %d is invalid or the bank is full\n", jointNumber);
+        }
+    }
+
+    // Optional fractional velocity commands, the commands are the step frequencies << fraction bits
+    if (config["Command Fraction Bits"].is<int>()) {
+        int fractionBits = config["Command Fraction Bits"];
+        if (fractionBits < 0 || fractionBits > 12) fractionBits = 0;
+        if (fractionBits > resolutionBits) fractionBits = resolutionBits;
+        printf("  Velocity commands with %d fraction bits\n", fractionBits);
+        bank->setCommandFractionBits(fractionBits);
+    }
+
+    // Optional fractional feedback, the feedback is the position in steps << fraction bits
+    if (config["Feedback Fraction Bits"].is<int>()) {
+        int fractionBits = config["Feedback Fraction Bits"];
+        if (fractionBits < 0 || fractionBits > 12) fractionBits = 0;
+        printf("  Feedback with %d fraction bits\n", fractionBits);
+        bank->setFeedbackFractionBits(fractionBits);
+    }
+
+    return bank;
+}
+
+/**
+ * @brief Constructor for the StepgenBank class.
+ *
+ * @param _threadFreq The thread frequency used for scaling the frequency commands.
+ * @param _resolutionBits The number of fractional bits in the DDS add values.
+ * @param _rxData The incoming data, for the frequency commands and joint enables.
+ * @param _txData The outgoing data, for the position feedback.
+ */
+StepgenBank::StepgenBank(int32_t _threadFreq, int _resolutionBits, volatile rxData_t& _rxData, volatile txData_t& _txData)
+    : jointCount(0),
+      resolutionBits(_resolutionBits),
+      commandShift(_resolutionBits),
+      stepUnits(0),
+      feedbackFractionBits(0),
+      fractionScale(0),
+      ptrRxData(&_rxData),
+      ptrTxData(&_txData),
+      jointNumber{},
+      DDSaccumulator{},
+      DDSaddValue{},
+      rawCount{},
+      stepMask(0),
+      directionMask(0),
+      enableMask(0),
+      enableWritten(0),
+      enableInitialised(false),
+      enableOutput{},
+      stepOutput{},
+      directionOutput{},
+      portWriterBound(false)
+{
+	usesModulePost = true;
+	changeThreadFreq(_threadFreq);
+	bindTasks<StepgenBank>();
+}
+
+/**
+ * @brief Adds a joint to the bank.
+ *
+ * @param _jointNumber The LinuxCNC joint number.
+ * @param _enable The name of the enable pin.
+ * @param _step The name of the step pin.
+ * @param _direction The name of the direction pin.
+ * @return false if the bank is full or the joint number is out of range.
+ */
+bool StepgenBank::addJoint(int _jointNumber, const char* _enable, const char* _step, const char* _direction)
+{
+    if (jointCount >= maxJoints || _jointNumber < 0 || _jointNumber >= (int)Config::joints) return false;
+
+    uint32_t i = jointCount;
+    jointNumber[i] = _jointNumber;
+    enablePin[i] = ModuleArena::makeUnique<Pin>(_enable, OUTPUT);
+    stepPin[i] = ModuleArena::makeUnique<Pin>(_step, OUTPUT);
+    directionPin[i] = ModuleArena::makeUnique<Pin>(_direction, OUTPUT);
+    jointCount++;
+    return true;
+}
+
+/**
+ * @brief Runs the DDS for every joint, then sets the step and direction pins.
+ *
+ * The first loop only touches the state arrays and builds the step, direction
+ * and enable bitmasks, the pins are written from the bitmasks afterwards. The
+ * DDS is exact integer arithmetic, there is no drift from the commanded steps.
+ */
+void StepgenBank::update()
+{
+    uint32_t jointEnable = ptrRxData->jointEnable;
+    uint32_t steps = 0;
+    uint32_t forward = 0;
+    uint32_t enabled = 0;
+
+    for (uint32_t i = 0; i < jointCount; i++) {
+        uint32_t isEnabled = (jointEnable >> jointNumber[i]) & 1;
+        int64_t addValue = (int64_t)ptrRxData->jointFreqCmd[jointNumber[i]] * ((int64_t)1 << commandShift);
+        addValue = isEnabled ? addValue : 0;
+        addValue = addValue >= stepUnits ? stepUnits - 1 : addValue;     // at most one step per tick
+        addValue = addValue <= -stepUnits ? 1 - stepUnits : addValue;
+
+        // the accumulator counts stepUnits per step, a wrap either way is a step
+        int64_t accumulator = DDSaccumulator[i] + addValue;
+        uint32_t stepForward = accumulator >= stepUnits;
+        uint32_t stepBackward = accumulator < 0;
+        accumulator -= stepForward ? stepUnits : 0;
+        accumulator += stepBackward ? stepUnits : 0;
+
+        uint32_t isStep = stepForward | stepBackward;
+        uint32_t isForward = addValue > 0;
+
+        DDSaccumulator[i] = accumulator;
+        rawCount[i] += (int32_t)stepForward - (int32_t)stepBackward;
+        DDSaddValue[i] = addValue;
+
+        steps |= isStep << i;
+        forward |= isForward << i;
+        enabled |= isEnabled << i;
+    }
+
+    stepMask = steps;
+    directionMask = forward;
+    enableMask = enabled;
+
+    writeEnables();
+
+    for (uint32_t i = 0; steps; i++, steps >>= 1) {
+        if (!(steps & 1)) continue;
+        writeOutput(*directionPin[i], directionOutput[i], (directionMask >> i) & 1);
+        writeOutput(*stepPin[i], stepOutput[i], true);
+        if (!feedbackFractionBits) ptrTxData->jointFeedback[jointNumber[i]] = rawCount[i];
+    }
+
+    // With fractional feedback the positions move every tick, count and fraction
+    // are written as one 32 bit store
+    if (feedbackFractionBits) {
+        for (uint32_t i = 0; i < jointCount; i++) {
+            uint32_t fraction = (uint32_t)(((uint64_t)DDSaccumulator[i] * fractionScale) >> fractionShift);
+            fraction = fraction >> feedbackFractionBits ? (1u << feedbackFractionBits) - 1 : fraction;
+            ptrTxData->jointFeedback[jointNumber[i]] = (int32_t)(((uint32_t)rawCount[i] << feedbackFractionBits) + fraction);
+        }
+    }
+}
+
+/**
+ * @brief Ends the step pulses started in update().
+ */
+void StepgenBank::updatePost()
+{
+    uint32_t steps = stepMask;
+    for (uint32_t i = 0; steps; i++, steps >>= 1) {
+        if (steps & 1) writeOutput(*stepPin[i], stepOutput[i], false);
+    }
+    stepMask = 0;
+}
+
+/**
+ * @brief Sets the number of fraction bits in the position feedback.
+ *
+ * @param _fractionBits The number of fraction bits, 0 to 12, 0 for a plain step count.
+ */
+void StepgenBank::setFeedbackFractionBits(uint32_t _fractionBits)
+{
+    feedbackFractionBits = _fractionBits;
+    scaleFeedbackFraction();
+}
+
+/**
+ * @brief Sets the number of fraction bits in the velocity commands.
+ *
+ * @param _fractionBits The number of fraction bits, 0 to 12 and at most the DDS resolution, 0 for whole Hz.
+ */
+void StepgenBank::setCommandFractionBits(uint32_t _fractionBits)
+{
+    commandShift = resolutionBits - _fractionBits;
+}
+
+void StepgenBank::scaleFeedbackFraction()
+{
+    // rounded up so exact phases are not truncated, the result is clamped below one step when used
+    fractionScale = feedbackFractionBits ? (((uint64_t)1 << (feedbackFractionBits + fractionShift)) + stepUnits - 1) / stepUnits : 0;
+}
+
+/**
+ * @brief Writes the enable pins of the joints whose enable has changed.
+ *
+ * The enable pins are active low, a disabled joint's pin is set.
+ */
+void StepgenBank::writeEnables()
+{
+    uint32_t changed = enableInitialised ? (enableMask ^ enableWritten) : ((1u << jointCount) - 1);
+    if (!changed) return;
+
+    for (uint32_t i = 0; changed; i++, changed >>= 1) {
+        if (changed & 1) writeOutput(*enablePin[i], enableOutput[i], !((enableMask >> i) & 1));
+    }
+    enableWritten = enableMask;
+    enableInitialised = true;
+}
+
+/**
+ * @brief Stages an output in the thread's PortWriter, or writes it directly.
+ */
+void StepgenBank::writeOutput(Pin& pin, const PortBit& output, bool value)
+{
+    if (portWriterBound) {
+        portWriter->stage(output, value);
+    } else {
+        pin.set(value);
+    }
+}
+
+/**
+ * @brief Rescales the frequency commands to a new thread frequency.
+ *
+ * @param _threadFreq The new thread frequency.
+ */
+void StepgenBank::changeThreadFreq(int32_t _threadFreq)
+{
+    Module::changeThreadFreq(_threadFreq);
+
+    // keep the accumulator phases through the change of units
+    int64_t units = (int64_t)_threadFreq << resolutionBits;
+    if (stepUnits) {
+        for (uint32_t i = 0; i < jointCount; i++) DDSaccumulator[i] = scaleDDSUnits(DDSaccumulator[i], units, stepUnits);
+    }
+    stepUnits = units;
+    scaleFeedbackFraction();
+}
+
+/**
+ * @brief Binds the joints' pins to the thread's PortWriter.
+ *
+ * @param writer The thread's PortWriter, or nullptr.
+ */
+void StepgenBank::setPortWriter(PortWriter* writer)
+{
+    portWriterBound = false;
+    Module::setPortWriter(writer);
+    if (!writer) return;
+
+    bool bound = true;
+    for (uint32_t i = 0; i < jointCount && bound; i++) {
+        bound = writer->bind(*enablePin[i], enableOutput[i]) &&
+                writer->bind(*stepPin[i], stepOutput[i]) &&
+                writer->bind(*directionPin[i], directionOutput[i]);
+    }
+    portWriterBound = bound;
+}
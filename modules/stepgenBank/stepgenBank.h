@@ -0,0 +1,81 @@
+#ifndef STEPGENBANK_H
+#define STEPGENBANK_H
+
+#include <cstdint>
+#include <memory>
+
+#include "../../remora.h"
+#include "../../modules/module.h"
+#include "../../thread/portWriter.h"
+#include "../../../remora-hal/pin/pin.h"
+
+/**
+ * @class StepgenBank
+ * @brief Step generator for several joints in one module.
+ *
+ * The StepgenBank keeps the DDS state of all its joints in contiguous arrays
+ * and processes them in a single loop each tick, producing a combined step and
+ * direction bitmask. The pins are then written from the bitmasks, through the
+ * thread's PortWriter when possible. This replaces one Stepgen module per joint
+ * and the per-joint call, enable reload and float multiply that go with it.
+ */
+class StepgenBank : public Module
+{
+private:
+
+	static constexpr uint32_t maxJoints = Config::joints;
+
+	uint32_t jointCount;                		/**< Number of joints in the bank */
+	uint32_t resolutionBits;            		/**< Fractional bits of the DDS add values */
+	uint32_t commandShift;              		/**< Velocity command to add value, resolutionBits - command fraction bits */
+	int64_t stepUnits;                  		/**< Accumulator units per step, threadFreq << resolutionBits */
+	static constexpr uint32_t fractionShift = 48;	/**< Fixed point shift of fractionScale */
+	uint32_t feedbackFractionBits;      		/**< Fraction bits in the position feedback, 0 for a plain step count */
+	uint64_t fractionScale;             		/**< Accumulator phase to feedback fraction, fixed point */
+
+	volatile rxData_t* ptrRxData;       		/**< Frequency commands and joint enables */
+	volatile txData_t* ptrTxData;       		/**< Position feedback */
+
+	// Per joint state, structure of arrays
+	uint8_t jointNumber[maxJoints];      		/**< LinuxCNC joint number */
+	int64_t DDSaccumulator[maxJoints];   		/**< The Direct Digital Synthesis (DDS) accumulators, 0 to stepUnits - 1 */
+	int64_t DDSaddValue[maxJoints];      		/**< Values added to the DDS accumulators */
+	int32_t rawCount[maxJoints];         		/**< Position counts */
+
+	uint32_t stepMask;                  		/**< Joints stepping this tick, bit per bank index */
+	uint32_t directionMask;             		/**< Joints moving forward, bit per bank index */
+	uint32_t enableMask;                		/**< Enabled joints, bit per bank index */
+	uint32_t enableWritten;             		/**< Enable state written to the pins */
+	bool enableInitialised;             		/**< Flag indicating the enable pins have been written */
+
+	ModuleArena::Ptr<Pin> enablePin[maxJoints];
+	ModuleArena::Ptr<Pin> stepPin[maxJoints];
+	ModuleArena::Ptr<Pin> directionPin[maxJoints];
+	PortBit enableOutput[maxJoints];
+	PortBit stepOutput[maxJoints];
+	PortBit directionOutput[maxJoints];
+	bool portWriterBound;               		/**< Flag indicating the pins are staged through the PortWriter */
+
+	void writeOutput(Pin& pin, const PortBit& output, bool value);
+	void writeEnables();
+	void scaleFeedbackFraction();
+
+public:
+
+	StepgenBank(int32_t _threadFreq, int _resolutionBits, volatile rxData_t& _rxData, volatile txData_t& _txData);
+	static std::shared_ptr<Module> create(const JsonObject& config, Remora* instance);
+
+	void setFeedbackFractionBits(uint32_t _fractionBits);
+	void setCommandFractionBits(uint32_t _fractionBits);
+	bool addJoint(int _jointNumber, const char* _enable, const char* _step, const char* _direction);
+
+	void update(void) override;
+	void updatePost(void) override;
+	void changeThreadFreq(int32_t _threadFreq) override;
+	void setPortWriter(PortWriter* writer) override;
+
+	uint32_t getStepMask() const { return stepMask; }
+	uint32_t getDirectionMask() const { return directionMask; }
+};
+
+#endif // STEPGENBANK_H
@@ -10,6 +10,7 @@ std::shared_ptr<Module> Temperature::create(const JsonObject& config, Remora* in
 
     int pv = config["PV[i]"];
     const char* sensor = config["Sensor"];
+    if (!instance->checkProcessVariable(pv, "PV[i]")) return nullptr;
 
     volatile float* ptrProcessVariable = &instance->getTxData()->processVariable[pv];
 
@@ -42,13 +43,17 @@ Temperature::Temperature(volatile float &ptrFeedback, int32_t threadFreq, int32_
     {
         printf("Creating Thermistor Tempearture measurement @ pin %s\n", this->pinSensor.c_str());
         //cout <<"Creating Thermistor Tempearture measurement @ pin " << this->pinSensor << endl;
-        this->Sensor = new Thermistor(this->pinSensor, this->beta, this->r0, this->t0);
+        this->Sensor = ModuleArena::make<Thermistor>(this->pinSensor, this->beta, this->r0, this->t0);
     }
     // TODO: Add more sensor types as needed
 
     // Take some readings to get the ADC up and running before moving on
     this->slowUpdate();
     this->slowUpdate();
+
+    // all of the work is done in slowUpdate, keep update() out of the thread
+    this->usesModuleUpdate = false;
+    bindTasks<Temperature>();
 }
 
 void Temperature::update()
@@ -56,20 +61,29 @@ void Temperature::update()
   return;
 }
 
+// The ADC read, logf and any error printf are too slow for the servo ISR,
+// hand the measurement to the main loop
 void Temperature::slowUpdate()
 {
-	this->temperaturePV = this->Sensor->getTemperature();
+    this->defer(measure);
+}
+
+void Temperature::measure(void* context, int32_t, float)
+{
+    Temperature* self = static_cast<Temperature*>(static_cast<Module*>(context));
+
+	self->temperaturePV = self->Sensor->getTemperature();
 
     // check for disconnected temperature sensor
-    if (this->temperaturePV > 0)
+    if (self->temperaturePV > 0)
     {
-        *(this->ptrFeedback) = this->temperaturePV;
+        *(self->ptrFeedback) = self->temperaturePV;
     }
     else
     {
-        printf("Temperature sensor error, pin %s reading = %f\n", this->pinSensor.c_str(), this->temperaturePV);
-        //cout << "Temperature sensor error, pin " << this->pinSensor << " reading = " << this->temperaturePV << endl;
-        *(this->ptrFeedback) = 999;
+        printf("Temperature sensor error, pin %s reading = %f\n", self->pinSensor.c_str(), self->temperaturePV);
+        //cout << "Temperature sensor error, pin " << self->pinSensor << " reading = " << self->temperaturePV << endl;
+        *(self->ptrFeedback) = 999;
     }
 
 }
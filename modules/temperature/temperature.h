@@ -19,6 +19,8 @@ class Temperature : public Module
 
     float temperaturePV;
 
+    static void measure(void* context, int32_t arg, float value);   // run from the main loop
+
     // thermistor parameters
     float beta;
     float r0;
@@ -15,7 +15,7 @@ std::shared_ptr<Module> TMC2208::create(const JsonObject& config, Remora* instan
     uint16_t microsteps = config["Microsteps"];
     bool stealthchop = (strcmp(config["Stealth chop"], "on") == 0);
 
-    return std::make_shared<TMC2208>(std::move(RxPin), RSense, current, microsteps, stealthchop, instance);
+    return std::make_unique<TMC2208>(std::move(RxPin), RSense, current, microsteps, stealthchop, instance);
 }
 
 TMC2208::TMC2208(std::string _rxtxPin, float _Rsense, uint16_t _mA, uint16_t _microsteps, bool _stealth, Remora* _instance)
@@ -24,7 +24,10 @@ TMC2208::TMC2208(std::string _rxtxPin, float _Rsense, uint16_t _mA, uint16_t _mi
       mA(_mA),
       microsteps(_microsteps),
       stealth(_stealth),
-      driver(std::make_unique<TMC2208Stepper>(rxtxPin, rxtxPin, Rsense)) {}
+      driver(std::make_unique<TMC2208Stepper>(rxtxPin, rxtxPin, Rsense))
+{
+    bindTasks<TMC2208>();
+}
 
 
 void TMC2208::configure()
@@ -17,7 +17,7 @@ std::shared_ptr<Module> TMC2209::create(const JsonObject& config, Remora* instan
     uint16_t stall = config["Stall sensitivity"];
     bool stealthchop = (strcmp(config["Stealth chop"], "on") == 0);
 
-    return std::make_shared<TMC2209>(std::move(RxPin), RSense, address, current, microsteps, stealthchop, stall, instance);
+    return std::make_unique<TMC2209>(std::move(RxPin), RSense, address, current, microsteps, stealthchop, stall, instance);
 }
 
 TMC2209::TMC2209(std::string _rxtxPin, float _Rsense, uint8_t _addr, uint16_t _mA, uint16_t _microsteps, bool _stealth, uint16_t _stall, Remora* _instance)
@@ -28,7 +28,10 @@ TMC2209::TMC2209(std::string _rxtxPin, float _Rsense, uint8_t _addr, uint16_t _m
       microsteps(_microsteps),
       stealth(_stealth),
       stall(_stall),
-      driver(std::make_unique<TMC2209Stepper>(rxtxPin, rxtxPin, Rsense, addr)) {}
+      driver(std::make_unique<TMC2209Stepper>(rxtxPin, rxtxPin, Rsense, addr))
+{
+    bindTasks<TMC2209>();
+}
 
 
 void TMC2209::configure()
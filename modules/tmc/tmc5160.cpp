@@ -21,7 +21,7 @@ std::shared_ptr<Module> TMC5160::create(const JsonObject& config, Remora* instan
     uint16_t stall = config["Stall sensitivity"];
     bool stealthchop = (strcmp(config["Stealth chop"], "on") == 0);
 
-    return std::make_shared<TMC5160>(std::move(pinCS), std::move(pinMOSI), std::move(pinMISO), std::move(pinSCK), RSense, address, current, microsteps, stealthchop, stall, instance);
+    return std::make_unique<TMC5160>(std::move(pinCS), std::move(pinMOSI), std::move(pinMISO), std::move(pinSCK), RSense, address, current, microsteps, stealthchop, stall, instance);
 }
 
 TMC5160::TMC5160(std::string _pinCS, std::string _pinMOSI, std::string _pinMISO, std::string _pinSCK, float _Rsense, uint8_t _addr, uint16_t _mA, uint16_t _microsteps, bool _stealth, uint16_t _stall, Remora* _instance)
@@ -35,7 +35,10 @@ TMC5160::TMC5160(std::string _pinCS, std::string _pinMOSI, std::string _pinMISO,
       microsteps(_microsteps),
       stealth(_stealth),
       stall(_stall),
-      driver(std::make_unique<TMC5160Stepper>(pinCS, _Rsense, pinMOSI, pinMISO, pinSCK)) {}
+      driver(std::make_unique<TMC5160Stepper>(pinCS, _Rsense, pinMOSI, pinMISO, pinSCK))
+{
+    bindTasks<TMC5160>();
+}
 
 
 void TMC5160::configure()
@@ -64,7 +67,7 @@ void TMC5160::configure()
     }
 
     // Use library accessors for DRV_STATUS flags for better accuracy
-    printf("Initial DRV_STATUS: 0x%08lX\n\r", driver->DRV_STATUS());
+    printf("Initial DRV_STATUS: 0x%08lX\n\r", (unsigned long)driver->DRV_STATUS());
     if (driver->ola()) printf("  OLA (Open Load A)\n\r");
     if (driver->olb()) printf("  OLB (Open Load B)\n\r");
     if (driver->s2ga()) printf("  S2GA (Short to Gnd A)\n\r");
@@ -79,7 +82,7 @@ void TMC5160::configure()
     // Explicitly read and print IOIN register (raw value)
     // The TMC5160Stepper class should have public constants for register addresses
     // Assuming TMC5160Stepper::IOIN is the address (typically 0x06)
-    printf("Raw IOIN read: 0x%08lX (Expected version in bits 31:24)\n\r", driver->IOIN());
+    printf("Raw IOIN read: 0x%08lX (Expected version in bits 31:24)\n\r", (unsigned long)driver->IOIN());
 
     // Configure driver settings
     printf("Configuring driver\n");
@@ -0,0 +1,98 @@
+#ifndef VELOCITYESTIMATOR_H
+#define VELOCITYESTIMATOR_H
+
+#include <cstdint>
+
+// Encoder velocity from the position count, sampled once per thread tick.
+//
+// Hybrid M/T and 1/T: the velocity is the count change between two edges
+// divided by the ticks between them. The measurement window runs from an edge
+// to the first edge at least windowTicks later, so at speed many counts are
+// averaged over about one window (M/T) and at low speed the window stretches to
+// the period between single edges (1/T). While no edge arrives the velocity is
+// limited to one count per elapsed time, so it decays towards zero rather than
+// holding the last value, and reads zero below the minimum velocity.
+class VelocityEstimator
+{
+private:
+    float threadFreq = 0.0f;
+    uint32_t windowTicks = 1;       // minimum ticks per measurement
+    uint32_t timeoutTicks = 1;      // ticks without an edge before the velocity is zero
+    uint32_t windowFreq = 1;        // measurement rate, eg the servo frequency (Hz)
+    float minVelocity = 1.0f;       // counts per second
+
+    int32_t windowCount = 0;        // count at the start of the window
+    int32_t lastCount = 0;
+    uint32_t windowAge = 0;         // ticks since the start of the window
+    uint32_t edgeAge = 0;           // ticks since the last edge
+    bool stopped = true;            // no window open, the next edge starts one
+    float velocity = 0.0f;          // counts per second
+    float edgeVelocity = 0.0f;      // velocity at the last measurement
+
+public:
+    // _windowFreq is the rate velocity is needed at, _minVelocity the slowest
+    // speed (counts per second) reported before reading zero
+    void configure(uint32_t _threadFreq, uint32_t _windowFreq, float _minVelocity)
+    {
+        windowFreq = _windowFreq ? _windowFreq : 1;
+        minVelocity = _minVelocity > 0.0f ? _minVelocity : 1.0f;
+        setThreadFreq(_threadFreq);
+    }
+
+    void setThreadFreq(uint32_t _threadFreq)
+    {
+        threadFreq = (float)_threadFreq;
+        windowTicks = _threadFreq / windowFreq;
+        if (windowTicks < 1) windowTicks = 1;
+        timeoutTicks = (uint32_t)(threadFreq / minVelocity);
+        if (timeoutTicks < windowTicks) timeoutTicks = windowTicks;
+    }
+
+    void reset(int32_t count)
+    {
+        windowCount = lastCount = count;
+        windowAge = edgeAge = 0;
+        stopped = true;
+        velocity = edgeVelocity = 0.0f;
+    }
+
+    // Call once per tick with the position count, returns counts per second
+    float update(int32_t count)
+    {
+        windowAge++;
+        edgeAge++;
+
+        if (count != lastCount) {
+            lastCount = count;
+            edgeAge = 0;
+
+            if (stopped) {
+                // first edge from standstill, the time since the previous edge is unknown
+                stopped = false;
+                windowCount = count;
+                windowAge = 0;
+            } else if (windowAge >= windowTicks) {
+                edgeVelocity = (float)(count - windowCount) * threadFreq / (float)windowAge;
+                velocity = edgeVelocity;
+                windowCount = count;
+                windowAge = 0;
+            }
+            return velocity;
+        }
+
+        if (edgeAge >= timeoutTicks) {
+            stopped = true;
+            velocity = edgeVelocity = 0.0f;
+        } else if (!stopped) {
+            // the next edge is at least edgeAge away
+            float limit = threadFreq / (float)edgeAge;
+            if (edgeVelocity > limit) velocity = limit;
+            else if (edgeVelocity < -limit) velocity = -limit;
+        }
+        return velocity;
+    }
+
+    float getVelocity() const { return velocity; }
+};
+
+#endif
@@ -21,15 +21,25 @@
 #include "../irqHandlers.h"
 #include "interrupt/interrupt.h"
 #include "json/jsonConfigHandler.h"
+#include "memory/moduleArena.h"
+
+#ifdef REMORA_STATIC_CONFIG
+#include REMORA_STATIC_CONFIG
+#endif
 
 // unions for TX and RX data
 volatile txData_t txData;
 volatile rxData_t rxData;
 
+// packet layout, the full rxData/txData until the config sets it
+PacketLayout packetLayout;
+
 Remora::Remora(std::shared_ptr<CommsHandler> commsHandler,
                std::unique_ptr<pruTimer> baseTimer,
                std::unique_ptr<pruTimer> servoTimer,
-               std::unique_ptr<pruTimer> serialTimer)
+               std::unique_ptr<pruTimer> serialTimer,
+               std::unique_ptr<CycleCounter> cycleCounter,
+               TimerFactory timerFactory)
 	: currentState(ST_SETUP),
 	  prevState(ST_SETUP),
 	  ptrTxData(&txData),
@@ -40,13 +50,20 @@ Remora::Remora(std::shared_ptr<CommsHandler> commsHandler,
 	  baseThread(nullptr),
 	  servoThread(nullptr),
 	  serialThread(nullptr),
+	  timerFactory(std::move(timerFactory)),
 	  onLoad(),
+	  cycleCounter(std::move(cycleCounter)),
 	  baseFreq(baseTimer->getFrequency()),
 	  servoFreq(servoTimer->getFrequency()),
 	  serialFreq(serialTimer ? serialTimer->getFrequency() : 0),
 	  threadsRunning(false)
 {
+    #ifdef REMORA_STATIC_CONFIG
+    // fixed configuration build, the threads and modules come from the static config header
+    StaticConfig::configureThreads(this);
+    #else
 	configHandler = std::make_unique<JsonConfigHandler>(this);
+    #endif
 
     updateHeader();
 
@@ -54,22 +71,108 @@ Remora::Remora(std::shared_ptr<CommsHandler> commsHandler,
     comms->start();
 
     baseThread = std::make_unique<pruThread>("BaseThread");
-    baseTimer->setOwner(baseThread.get());
     baseThread->setTimer(std::move(baseTimer));
 
     servoThread = std::make_unique<pruThread>("ServoThread");
-    servoTimer->setOwner(servoThread.get());
     servoThread->setTimer(std::move(servoTimer));
 
     if (serialTimer) {
         serialThread = std::make_unique<pruThread>("SerialThread");
         serialThread->setTimer(std::move(serialTimer));
-        serialTimer->setOwner(serialThread.get());
     }
 
+    threads.push_back(baseThread.get());
+    threads.push_back(servoThread.get());
+    if (serialThread) threads.push_back(serialThread.get());
+    for (const auto& configThread : configThreads) {
+        threads.push_back(configThread.thread.get());
+    }
+
+    // without a cycle counter the slower threads time their ticks against the base thread
+    for (pruThread* thread : threads) {
+        if (thread != baseThread.get()) thread->setTimebase(baseThread.get());
+    }
+
+    if (this->cycleCounter) {
+        this->cycleCounter->init();
+        for (pruThread* thread : threads) {
+            thread->setCycleCounter(this->cycleCounter.get());
+        }
+    }
+
+    // apply the frequencies from the JSON config, the threads did not exist when it was read
+    baseThread->setFrequency(baseFreq);
+    servoThread->setFrequency(servoFreq);
+
     servoThread->registerModule(comms);
 }
 
+void Remora::setBaseFreq(uint32_t freq)
+{
+    baseFreq = freq;
+    if (baseThread) baseThread->setFrequency(freq);
+}
+
+void Remora::setServoFreq(uint32_t freq)
+{
+    servoFreq = freq;
+    if (servoThread) servoThread->setFrequency(freq);
+
+    // modules in the other threads, eg the stepgen interpolation, follow the servo period
+    for (pruThread* thread : threads) thread->setServoFrequency(freq);
+}
+
+// Create a thread declared in the JSON "Threads" array. This is called while the
+// config is read, the timer comes from the platform's timer factory.
+void Remora::addThread(const char* name, uint32_t freq, uint32_t irqPriority)
+{
+    if (strcmp(name, "On load") == 0) {
+        printf("Error: 'On load' is not a thread, modules listed as \"On load\" run once at start up\n");
+        return;
+    }
+
+    if (getThread(name)) {
+        printf("Error: thread '%s' is already defined\n", name);
+        return;
+    }
+
+    std::unique_ptr<pruTimer> timer = timerFactory ? timerFactory(name, freq, irqPriority) : nullptr;
+    if (!timer) {
+        printf("Error: no timer available for thread '%s'\n", name);
+        setStatus(makeRemoraStatus(RemoraErrorSource::CORE, RemoraErrorCode::THREAD_CREATE_FAILED));
+        return;
+    }
+
+    std::unique_ptr<pruThread> thread = std::make_unique<pruThread>(std::string(name) + "Thread");
+    thread->setTimer(std::move(timer));
+    thread->setFrequency(freq);
+    configThreads.push_back({ name, std::move(thread) });
+}
+
+pruThread* Remora::getThread(const char* name)
+{
+    if (strcmp(name, "Base") == 0) return baseThread.get();
+    if (strcmp(name, "Servo") == 0) return servoThread.get();
+
+    for (const auto& configThread : configThreads) {
+        if (configThread.name == name) return configThread.thread.get();
+    }
+    return nullptr;
+}
+
+// A PV index read from a module's config. Past the packet layout's process
+// variables it would never reach the host, past Config::variables it would
+// point past txData, and the layout is never larger.
+bool Remora::checkProcessVariable(int pv, const char* key)
+{
+    uint32_t processVariables = packetLayout.getProcessVariables();
+    if (pv >= 0 && pv < (int)processVariables) return true;
+
+    printf("  %s %d is out of range, the packet carries %lu process variables\n", key, pv, (unsigned long)processVariables);
+    setStatus(makeRemoraStatus(RemoraErrorSource::MODULE_LOADER, RemoraErrorCode::MODULE_CONFIG_INVALID));
+    return false;
+}
+
 void Remora::updateHeader()
 {
     ptrTxData->header = Config::pruData | remoraStatus;
@@ -94,7 +197,19 @@ void Remora::printStateEntry(State state)
 
 void Remora::handleSetupState()
 {
+    // everything the modules allocate while loading comes from the module arena
+    ModuleArena::begin();
+    #ifdef REMORA_STATIC_CONFIG
+    StaticConfig::loadModules(this);
+    #else
     loadModules();
+    #endif
+    ModuleArena::end();
+
+    ModuleArena::report();
+    if (ModuleArena::getOverflows() && !(remoraStatus & 0x80)) {
+        setStatus(makeRemoraStatus(RemoraErrorSource::MODULE_LOADER, RemoraErrorCode::MODULE_ARENA_EXHAUSTED));
+    }
     transitionToState(ST_START);
 }
 
@@ -109,7 +224,13 @@ void Remora::handleStartState()
     if (!threadsRunning) {
         startThread(servoThread, "Servo");
         startThread(baseThread, "Base");
+        for (const auto& configThread : configThreads) {
+            startThread(configThread.thread, configThread.name.c_str());
+        }
         threadsRunning = true;
+
+        // the module set is complete, any heap allocation from here on is reported
+        ModuleArena::freeze();
     }
 
     transitionToState(ST_IDLE);
@@ -156,6 +277,95 @@ void Remora::resetBuffer(volatile uint8_t* buffer, size_t size)
     memset((void*)buffer, 0, size);
 }
 
+// Print the ISR timing histograms for each thread every Config::threadStatsInterval
+// seconds, timed from the base thread tick count. With MODULE_PROFILING the per
+// module report is printed alongside, or on demand via requestModuleReport().
+void Remora::reportThreadStats()
+{
+    if (!threadsRunning || !baseThread->hasStats()) return;
+
+    #ifdef MODULE_PROFILING
+    if (moduleReportRequested) {
+        moduleReportRequested = false;
+        for (const pruThread* thread : threads) {
+            if (thread->isRunning()) thread->printModuleReport(Config::moduleReportTopN);
+        }
+    }
+    #endif
+
+    if (Config::threadStatsInterval == 0) return;
+
+    uint32_t ticks = baseThread->getTicks();
+    if (ticks - lastStatsReport < Config::threadStatsInterval * baseThread->getFrequency()) return;
+
+    ThreadStatsData snapshot;
+    for (pruThread* thread : threads) {
+        if (!thread->isRunning()) continue;
+        thread->getStats(snapshot);
+        ThreadStats::print(thread->getName().c_str(), snapshot, cycleCounter->getFrequency());
+        uint32_t dropped = thread->getDeferredDropped();
+        if (dropped) printf("%s: %lu deferred work items dropped (queue full) since start\n", thread->getName().c_str(), (unsigned long)dropped);
+        thread->resetStats();
+    }
+    lastStatsReport = ticks;
+
+    #ifdef MODULE_PROFILING
+    moduleReportRequested = true;
+    #endif
+}
+
+// Flag thread overruns in the status byte so the host sees them. Only a clear
+// status is replaced, so clearing it again restores the status it replaced. An
+// overrun behind another status shows in the thread stats report.
+void Remora::checkThreadOverruns()
+{
+    uint32_t overruns = 0;
+    for (const pruThread* thread : threads) {
+        overruns += thread->getTotalOverruns();
+    }
+
+    uint8_t overrunStatus = makeRemoraStatus(RemoraErrorSource::CORE, RemoraErrorCode::THREAD_OVERRUN);
+    uint32_t now = baseThread->getTickCount();
+
+    if (overruns == lastOverruns) {
+        // clear the status once the threads have run clean for a while
+        if (remoraStatus == overrunStatus && now - lastOverrunTick >= Config::overrunClearSeconds * baseThread->getFrequency()) {
+            printf("Thread overruns have stopped\n");
+            setStatus(0);
+        }
+        return;
+    }
+
+    lastOverruns = overruns;
+    lastOverrunTick = now;
+
+    if (remoraStatus == 0) {
+        printf("Warning: thread overrun detected\n");
+        setStatus(overrunStatus);
+    }
+}
+
+// Report heap allocations of modules and their HAL objects made after the
+// module arena was frozen
+void Remora::checkLateAllocations()
+{
+    uint32_t late = ModuleArena::getLateAllocations();
+    if (late == lastLateAllocations) return;
+
+    if (lastLateAllocations == 0) {
+        printf("Warning: module or HAL object created after the threads started\n");
+    }
+    lastLateAllocations = late;
+}
+
+// Run the work the thread ISRs have handed to the main loop
+void Remora::runDeferredWork()
+{
+    for (pruThread* thread : threads) {
+        thread->runDeferredWork();
+    }
+}
+
 void Remora::run()
 {
     while (true) {
@@ -167,6 +377,7 @@ void Remora::run()
                 fatalErrorHandled = true;
             }
 
+            runDeferredWork();
             comms->tasks(); 
             continue;
         }
@@ -196,7 +407,7 @@ void Remora::run()
         }
 
         #ifdef ETH_CTRL
-        if (JsonConfigHandler::new_flash_json)
+        if (JsonConfigHandler::new_flash_json && configHandler)
         {
             printf("Checking new configuration file\n");
             if (configHandler->json_check_length_and_CRC() > 0)
@@ -211,6 +422,11 @@ void Remora::run()
         }
         #endif
 
+        reportThreadStats();
+        checkThreadOverruns();
+        checkLateAllocations();
+        runDeferredWork();
+
         comms->tasks();
     }
 }
@@ -229,13 +445,12 @@ void Remora::loadModules()
         if (modules[i]["Thread"].is<const char*>() && modules[i]["Type"].is<const char*>()) {
             const char* threadName = modules[i]["Thread"];
             const char* moduleType = modules[i]["Type"];
+            pruThread* thread = getThread(threadName);
             uint32_t threadFreq = 0;
 
             // Determine the thread frequency based on the thread name
-            if (strcmp(threadName, "Servo") == 0) {
-                threadFreq = servoFreq;
-            } else if (strcmp(threadName, "Base") == 0) {
-                threadFreq = baseFreq;
+            if (thread) {
+                threadFreq = thread->getFrequency();
             }
 
             // Add the "ThreadFreq" key and its value to the module's JSON object
@@ -251,18 +466,24 @@ void Remora::loadModules()
                 continue; // Skip to the next iteration
             }
 
-            bool _modPost = _mod->getUsesModulePost();
+            #ifdef MODULE_PROFILING
+            _mod->setName(moduleType, modules[i]["Comment"]);
+            #endif
 
-            if (strcmp(threadName, "Servo") == 0) {
-                servoThread->registerModule(_mod);
-                if (_modPost) {
-                    servoThread->registerModulePost(_mod);
+            // Optional priority, "Low" priority modules are shed when the thread is overloaded
+            if (modules[i]["Priority"].is<const char*>()) {
+                const char* priority = modules[i]["Priority"];
+                if (strcmp(priority, "Low") == 0) {
+                    _mod->setPriority(PRIORITY_LOW);
                 }
             }
-            else if (strcmp(threadName, "Base") == 0) {
-                baseThread->registerModule(_mod);
+
+            bool _modPost = _mod->getUsesModulePost();
+
+            if (thread) {
+                thread->registerModule(_mod);
                 if (_modPost) {
-                    baseThread->registerModulePost(_mod);
+                    thread->registerModulePost(_mod);
                 }
             }
             else {
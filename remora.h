@@ -1,7 +1,9 @@
 #ifndef REMORA_H
 #define REMORA_H
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <ArduinoJson.h>
@@ -10,9 +12,12 @@
 #include "data.h"
 #include "remoraStatus.h"
 #include "comms/commsInterface.h"
+#include "comms/packetLayout.h"
 #include "modules/moduleFactory.h"
 #include "modules/moduleList.h"
 #include "thread/pruThread.h"
+#include "thread/cycleCounter.h"
+#include "thread/pulseOutput.h"
 
 #define MAJOR_VERSION 	2
 #define MINOR_VERSION	0
@@ -21,6 +26,14 @@
 class CommsHandler;
 class JsonConfigHandler;
 
+// Supplies a hardware timer for a thread declared in the JSON "Threads" array,
+// returns nullptr when the platform has no free timer
+typedef std::function<std::unique_ptr<pruTimer>(const char* name, uint32_t frequency, uint32_t irqPriority)> TimerFactory;
+
+// Supplies a timer pulse output driving the named pin, returns nullptr when the
+// pin has no timer channel
+typedef std::function<std::unique_ptr<PulseOutput>(const char* pin)> PulseOutputFactory;
+
 class Remora {
 private:
 
@@ -47,7 +60,23 @@ private:
     std::unique_ptr<pruThread> baseThread;
     std::unique_ptr<pruThread> servoThread;
     std::unique_ptr<pruThread> serialThread;
+
+    // threads declared in the JSON config in addition to Base and Servo
+    struct ConfigThread {
+        std::string name;
+        std::unique_ptr<pruThread> thread;
+    };
+    std::vector<ConfigThread> configThreads;
+    std::vector<pruThread*> threads;       // every realtime thread, for the main loop housekeeping
+    TimerFactory timerFactory;
+    PulseOutputFactory pulseOutputFactory;
     std::vector<std::shared_ptr<Module>> onLoad;
+    std::unique_ptr<CycleCounter> cycleCounter;
+    uint32_t lastStatsReport = 0;
+    uint32_t lastOverruns = 0;
+    uint32_t lastOverrunTick = 0;
+    uint32_t lastLateAllocations = 0;
+    bool moduleReportRequested = false;
 
     uint32_t baseFreq;
     uint32_t servoFreq;
@@ -70,27 +99,40 @@ private:
     void startThread(const std::unique_ptr<pruThread>&, const char*);
     void resetBuffer(volatile uint8_t*, size_t);
     void loadModules();
+    void reportThreadStats();
+    void runDeferredWork();
+    void checkThreadOverruns();
+    void checkLateAllocations();
 
 public:
 
     Remora(std::shared_ptr<CommsHandler> commsHandler,
            std::unique_ptr<pruTimer> baseTimer,
            std::unique_ptr<pruTimer> servoTimer,
-           std::unique_ptr<pruTimer> serialTimer = nullptr);
+           std::unique_ptr<pruTimer> serialTimer = nullptr,
+           std::unique_ptr<CycleCounter> cycleCounter = nullptr,
+           TimerFactory timerFactory = nullptr);
 
     void run();
 	
-    void setBaseFreq(uint32_t freq) { baseFreq = freq; /* baseThread->setFrequency(freq); */}        // these setters and getters works at init during JSON Config, but not during run time, could use a refactor. Would require a new setter method in pruThread::
-    void setServoFreq(uint32_t freq) { servoFreq = freq; /* servoThread->setFrequency(freq); */}
-    uint32_t getBaseFreq(void) { return baseFreq; /* return baseThread->getFrequency();*/}
-    uint32_t getServoFreq(void) { return servoFreq; /* return servoThread->getFrequency(); */}    
+    void setBaseFreq(uint32_t freq);        // during JSON config this sets the start up frequency, while running the thread is retimed at the next tick
+    void setServoFreq(uint32_t freq);
+    void addThread(const char* name, uint32_t freq, uint32_t irqPriority);
+    pruThread* getThread(const char* name);     // by JSON thread name, nullptr for "On load" or unknown names
+    void setPulseOutputFactory(PulseOutputFactory factory) { pulseOutputFactory = std::move(factory); }   // set before run()
+    std::unique_ptr<PulseOutput> createPulseOutput(const char* pin) { return pulseOutputFactory ? pulseOutputFactory(pin) : nullptr; }     // nullptr when the pin has no timer output
+    uint32_t getBaseFreq(void) { return baseFreq; }
+    uint32_t getServoFreq(void) { return servoFreq; }
     void setStatus(uint8_t status) { remoraStatus = status; }
     uint8_t getStatus() { return remoraStatus; }
 
     volatile txData_t* getTxData() { return &txData; }
     volatile rxData_t* getRxData() { return &rxData; }
+    PacketLayout& getPacketLayout() { return packetLayout; }       // configure before the comms start
+    bool checkProcessVariable(int pv, const char* key);            // for the module factories, false and a config status when out of range
     volatile bool* getReset() { return &reset; }
     pruThread* getSerialThread() { return serialThread.get(); }
+    void requestModuleReport() { moduleReportRequested = true; }  // printed from the main loop when built with MODULE_PROFILING
 };
 
 #endif
@@ -21,6 +21,8 @@ enum class RemoraErrorCode : uint8_t {
 
     // CORE
     REMORA_CORE_ERROR         = 0x01,
+    THREAD_OVERRUN            = 0x02,
+    THREAD_CREATE_FAILED      = 0x03,
 
     // JSON_CONFIG
     SD_MOUNT_FAILED           = 0x01,
@@ -30,9 +32,12 @@ enum class RemoraErrorCode : uint8_t {
     CONFIG_NO_MEMORY          = 0x05,
     CONFIG_PARSE_FAILED       = 0x06,
     CONFIG_LOADED_DEFAULT     = 0x07,
+    PACKET_LAYOUT_INVALID     = 0x08,
 
     // MODULE_LOADER
     MODULE_CREATE_FAILED      = 0x01,
+    MODULE_ARENA_EXHAUSTED    = 0x02,
+    MODULE_CONFIG_INVALID     = 0x03,
 
     // TMC_DRIVER
     TMC_DRIVER_ERROR          = 0x01,
@@ -1,4 +1,5 @@
 #include "thermistor.h"
+#include "../../memory/moduleArena.h"
 
 
 Thermistor::Thermistor(std::string pin, float beta, int r0, int t0) :
@@ -11,7 +12,7 @@ Thermistor::Thermistor(std::string pin, float beta, int r0, int t0) :
 	this->j = (1.0F / this->beta);
 	this->k = (1.0F / (this->t0 + 273.15F));
 
-    this->adc = new AnalogIn(this->pin);
+    this->adc = ModuleArena::make<AnalogIn>(this->pin);
 	this->r1 = 0;
 	this->r2 = 4700;
 }
@@ -0,0 +1,287 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Timing, instruction counting and baseline comparison for the host
+// benchmarks in sim/bench.
+//
+// Each benchmark is a call run many times. It is timed as the best of several
+// runs, the least disturbed by the host, and the whole suite is run several
+// passes with the best of each benchmark kept, so a disturbance lasting longer
+// than a run does not land on one benchmark in every pass. Instructions come from the CPU's
+// counter through perf_event_open, where the host allows it, and are n/a
+// otherwise (eg in most VMs). The GPIO accesses come from the simulated Pin's
+// counters. Instructions and GPIO accesses are repeatable on any host and an
+// increase in either always fails the comparison. Time fails beyond a
+// tolerance, 25% by default. Where the host has no instruction counter it is
+// the only gate on the work done. A host can change speed for seconds at a
+// time, so a suite with a time beyond the tolerance is run again, up to three
+// times, keeping the best of each benchmark, and the time only fails when it
+// stays slow. Time is only comparable on the machine that wrote the baseline,
+// --no-time reports it without failing elsewhere.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "remora-hal/pin/pin.h"
+
+namespace Bench {
+
+struct Result {
+    std::string name;
+    double ns;                  // per call
+    double instructions;        // per call, < 0 when not available
+    double gpio;                // Pin accesses per call
+};
+
+class InstructionCounter
+{
+private:
+    int fd = -1;
+
+public:
+    InstructionCounter()
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~InstructionCounter() { if (fd >= 0) close(fd); }
+
+    bool available() const { return fd >= 0; }
+
+    void start()
+    {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t stop()
+    {
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return 0;
+        return count;
+    }
+};
+
+inline InstructionCounter& instructionCounter()
+{
+    static InstructionCounter counter;
+    return counter;
+}
+
+inline uint64_t gpioAccesses()
+{
+    const Pin::Counters& counters = Pin::getCounters();
+    return counters.set + counters.get + counters.writePort + counters.readPort;
+}
+
+// Run call() calls times per run, keep the best of runs. Call is a callable,
+// not a std::function, so only the benchmarked code is in the loop.
+template <typename Call>
+Result measure(const char* name, Call&& call, uint64_t calls = 200000, uint32_t runs = 7)
+{
+    InstructionCounter& counter = instructionCounter();
+    Result result = { name, 1e30, counter.available() ? 1e30 : -1.0, 0.0 };
+
+    for (uint64_t i = 0; i < calls / 10; i++) call();      // warm up
+
+    for (uint32_t run = 0; run < runs; run++) {
+        Pin::resetCounters();
+        counter.start();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < calls; i++) call();
+        auto end = std::chrono::steady_clock::now();
+        uint64_t instructions = counter.stop();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / calls;
+        result.ns = std::min(result.ns, ns);
+        if (counter.available()) result.instructions = std::min(result.instructions, (double)instructions / calls);
+        result.gpio = (double)gpioAccesses() / calls;
+    }
+    return result;
+}
+
+// Add a result, or keep the better of it and an earlier pass's
+inline void keepBest(std::vector<Result>& results, const Result& result)
+{
+    for (Result& r : results) {
+        if (r.name != result.name) continue;
+        r.ns = std::min(r.ns, result.ns);
+        if (r.instructions >= 0) r.instructions = std::min(r.instructions, result.instructions);
+        r.gpio = std::min(r.gpio, result.gpio);
+        return;
+    }
+    results.push_back(result);
+}
+
+// The baseline file, one result per line:
+//      name ns instructions gpio
+// with n/a for instructions the host could not count. Names have no spaces.
+inline bool writeBaseline(const char* path, const std::vector<Result>& results)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "# name ns/call instructions/call gpio/call\n");
+    for (const Result& r : results) {
+        if (r.instructions >= 0) fprintf(file, "%s %.2f %.1f %.3f\n", r.name.c_str(), r.ns, r.instructions, r.gpio);
+        else fprintf(file, "%s %.2f n/a %.3f\n", r.name.c_str(), r.ns, r.gpio);
+    }
+    fclose(file);
+    return true;
+}
+
+inline bool readBaseline(const char* path, std::map<std::string, Result>& baseline)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[256], name[128], instructions[32];
+    double ns, gpio;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%127s %lf %31s %lf", name, &ns, instructions, &gpio) != 4) continue;
+        double count = strcmp(instructions, "n/a") ? atof(instructions) : -1.0;
+        baseline[name] = { name, ns, count, gpio };
+    }
+    fclose(file);
+    return true;
+}
+
+// Print the results against the baseline, returns the number of regressions.
+// Instructions regress beyond 2% and GPIO accesses on any increase. Time beyond
+// timeTolerance (a fraction) is flagged, and is a regression when timeFails.
+inline int report(const std::vector<Result>& results, const std::map<std::string, Result>& baseline,
+                  double timeTolerance, bool timeFails)
+{
+    int regressions = 0;
+
+    printf("%-40s %10s %10s %8s   %s\n", "benchmark", "ns/call", "instr/call", "gpio", "vs baseline");
+    for (const Result& r : results) {
+        char instructions[32] = "n/a";
+        if (r.instructions >= 0) snprintf(instructions, sizeof(instructions), "%.1f", r.instructions);
+        printf("%-40s %10.2f %10s %8.3f   ", r.name.c_str(), r.ns, instructions, r.gpio);
+
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            printf("new\n");
+            continue;
+        }
+
+        const Result& b = it->second;
+        bool slower = r.ns > b.ns * (1.0 + timeTolerance);
+        std::string verdict;
+        if (slower && timeFails) verdict += " TIME";
+        if (r.instructions >= 0 && b.instructions >= 0 && r.instructions > b.instructions * 1.02) verdict += " INSTRUCTIONS";
+        if (r.gpio > b.gpio + 0.0005) verdict += " GPIO";
+
+        printf("%+6.1f%% time", (r.ns / b.ns - 1.0) * 100.0);
+        if (r.instructions >= 0 && b.instructions >= 0) printf(", %+6.1f%% instr", (r.instructions / b.instructions - 1.0) * 100.0);
+        if (!verdict.empty()) {
+            printf("  REGRESSION:%s\n", verdict.c_str());
+            regressions++;
+        } else if (slower) {
+            printf("  slower\n");
+        } else {
+            printf("\n");
+        }
+    }
+    return regressions;
+}
+
+// Common command line: [--baseline file] [--write file] [--tolerance percent] [--no-time] [--filter text] [--passes n]
+struct Options {
+    const char* baseline = nullptr;
+    const char* write = nullptr;
+    double tolerance = 0.25;
+    bool timeFails = true;      // cleared by --no-time
+    const char* filter = nullptr;
+    uint32_t passes = 5;
+    uint32_t attempts = 3;      // suite runs while a time is beyond the tolerance
+};
+
+inline bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--baseline") && hasValue) options.baseline = argv[++i];
+        else if (!strcmp(argv[i], "--write") && hasValue) options.write = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && hasValue) options.tolerance = atof(argv[++i]) / 100.0;
+        else if (!strcmp(argv[i], "--no-time")) options.timeFails = false;
+        else if (!strcmp(argv[i], "--filter") && hasValue) options.filter = argv[++i];
+        else if (!strcmp(argv[i], "--passes") && hasValue && atoi(argv[i + 1]) > 0) options.passes = atoi(argv[++i]);
+        else {
+            printf("usage: %s [--baseline file] [--write file] [--tolerance percent] [--no-time] [--filter text] [--passes n]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool selected(const Options& options, const char* name)
+{
+    return !options.filter || strstr(name, options.filter);
+}
+
+// True when the suite should be run again, a time is beyond the tolerance of
+// the baseline
+inline bool retry(const Options& options, const std::vector<Result>& results)
+{
+    std::map<std::string, Result> baseline;
+    if (!options.timeFails || !options.baseline || !readBaseline(options.baseline, baseline)) return false;
+
+    for (const Result& r : results) {
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && r.ns > it->second.ns * (1.0 + options.tolerance)) return true;
+    }
+    return false;
+}
+
+// Report, compare and write as the options ask, returns the exit status
+inline int finish(const Options& options, const std::vector<Result>& results)
+{
+    std::map<std::string, Result> baseline;
+    if (options.baseline && !readBaseline(options.baseline, baseline)) {
+        printf("No baseline at %s, reporting only\n", options.baseline);
+    }
+
+    if (!instructionCounter().available()) printf("Instruction counts not available on this host\n");
+    int regressions = report(results, baseline, options.tolerance, options.timeFails);
+
+    if (options.write) {
+        if (!writeBaseline(options.write, results)) {
+            printf("Could not write %s\n", options.write);
+            return 2;
+        }
+        printf("Baseline written to %s\n", options.write);
+    }
+
+    if (regressions) printf("%d regression(s)\n", regressions);
+    return regressions ? 1 : 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+// config-bench, a static config (REMORA_STATIC_CONFIG) against the module
+// layout the JSON config builds, on the host.
+//
+// The module set of staticConfigExample.h, 3 Stepgens in Base and 2
+// DigitalPins in Servo, built two ways:
+//
+//      static      StaticPipelines as staticConfigExample.h builds them, one
+//                  task per thread
+//      dynamic     one heap module per entry, registered in its thread one by
+//                  one, as Remora::loadModules() does with what the factory
+//                  returns
+//
+// boot is the module construction and thread registration, throughput the
+// base tick with a servo tick every Base / Servo ticks. The JSON parse and the
+// factory lookup are not part of the dynamic figures, the host build has no
+// JSON parser (project/ArduinoJson.h), so boot only shows the layout's share.
+//
+//      config-bench [passes]
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "data.h"
+#include "modules/digitalPin/digitalPin.h"
+#include "modules/staticPipeline.h"
+#include "modules/stepgen/stepgen.h"
+#include "thread/pruThread.h"
+#include "thread/virtualTimer.h"
+
+static constexpr uint32_t baseFreq = 40000;
+static constexpr uint32_t servoFreq = 1000;
+
+static const char* const enablePins[] = { "PA_0", "PA_7", "PA_8" };
+static const char* const stepPins[] = { "PA_1", "PA_3", "PA_5" };
+static const char* const directionPins[] = { "PA_2", "PA_4", "PA_6" };
+
+struct Layout {
+    pruThread base{"Base"};
+    pruThread servo{"Servo"};
+    uint32_t tick = 0;
+
+    void update()
+    {
+        base.update();
+        if (++tick == baseFreq / servoFreq) {
+            tick = 0;
+            servo.update();
+        }
+    }
+
+    void start()
+    {
+        base.setTimer(std::make_unique<VirtualTimer>(baseFreq));
+        servo.setTimer(std::make_unique<VirtualTimer>(servoFreq));
+        base.startThread();
+        servo.startThread();
+    }
+};
+
+struct StaticLayout : Layout {
+    StaticPipeline<Stepgen, Stepgen, Stepgen> basePipeline;
+    StaticPipeline<DigitalPin, DigitalPin> servoPipeline;
+
+    StaticLayout()
+    {
+        basePipeline.emplace<0>(baseFreq, 0, enablePins[0], stepPins[0], directionPins[0], Config::ddsResolutionBits,
+                                rxData.jointFreqCmd[0], txData.jointFeedback[0], rxData.jointEnable, true);
+        basePipeline.emplace<1>(baseFreq, 1, enablePins[1], stepPins[1], directionPins[1], Config::ddsResolutionBits,
+                                rxData.jointFreqCmd[1], txData.jointFeedback[1], rxData.jointEnable, true);
+        basePipeline.emplace<2>(baseFreq, 2, enablePins[2], stepPins[2], directionPins[2], Config::ddsResolutionBits,
+                                rxData.jointFreqCmd[2], txData.jointFeedback[2], rxData.jointEnable, true);
+        servoPipeline.emplace<0>(rxData.outputs, 1, "PB_0", 0, false, NONE);
+        servoPipeline.emplace<1>(txData.inputs, 0, "PB_1", 0, false, PULLUP);
+
+        base.registerModule(basePipeline.shared());
+        if (basePipeline.getUsesModulePost()) base.registerModulePost(basePipeline.shared());
+        servo.registerModule(servoPipeline.shared());
+        if (servoPipeline.getUsesModulePost()) servo.registerModulePost(servoPipeline.shared());
+    }
+};
+
+struct DynamicLayout : Layout {
+    DynamicLayout()
+    {
+        auto add = [](pruThread& thread, std::shared_ptr<Module> module) {
+            thread.registerModule(module);
+            if (module->getUsesModulePost()) thread.registerModulePost(module);
+        };
+
+        for (int i = 0; i < 3; i++) {
+            add(base, std::make_unique<Stepgen>(baseFreq, i, enablePins[i], stepPins[i], directionPins[i], Config::ddsResolutionBits,
+                                                rxData.jointFreqCmd[i], txData.jointFeedback[i], rxData.jointEnable, true));
+        }
+        add(servo, std::make_unique<DigitalPin>(rxData.outputs, 1, "PB_0", 0, false, NONE));
+        add(servo, std::make_unique<DigitalPin>(txData.inputs, 0, "PB_1", 0, false, PULLUP));
+    }
+};
+
+// The threads report each registration, stdout goes to /dev/null while the
+// layouts are built so the figures are not the terminal's
+class Quiet
+{
+private:
+    int saved;
+
+public:
+    Quiet()
+    {
+        fflush(stdout);
+        saved = dup(STDOUT_FILENO);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        close(null);
+    }
+
+    ~Quiet()
+    {
+        fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    uint32_t passes = argc > 1 ? atoi(argv[1]) : 5;
+    if (passes == 0) {
+        printf("usage: %s [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    rxData.jointEnable = 0x07;
+    rxData.jointFreqCmd[0] = 10000;
+    rxData.jointFreqCmd[1] = -7000;
+    rxData.jointFreqCmd[2] = 3000;
+    rxData.outputs = 0x0001;
+
+    std::vector<Bench::Result> results;
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        {
+            Quiet quiet;
+            Bench::keepBest(results, Bench::measure("boot_static", [] { StaticLayout layout; }, 2000));
+            Bench::keepBest(results, Bench::measure("boot_dynamic", [] { DynamicLayout layout; }, 2000));
+        }
+
+        StaticLayout staticLayout;
+        DynamicLayout dynamicLayout;
+        staticLayout.start();
+        dynamicLayout.start();
+        Bench::keepBest(results, Bench::measure("tick_static", [&] { staticLayout.update(); }));
+        Bench::keepBest(results, Bench::measure("tick_dynamic", [&] { dynamicLayout.update(); }));
+    }
+
+    auto ns = [&](const char* name) {
+        for (const Bench::Result& r : results) {
+            if (r.name == name) return r.ns;
+        }
+        return 0.0;
+    };
+
+    printf("\n## Static against dynamic config, best of %lu passes\n", (unsigned long)passes);
+    printf("%-24s %10s %10s %16s\n", "", "static", "dynamic", "static/dynamic");
+    printf("%-24s %10.0f %10.0f %15.2fx\n", "boot, ns", ns("boot_static"), ns("boot_dynamic"), ns("boot_static") / ns("boot_dynamic"));
+    printf("%-24s %10.1f %10.1f %15.2fx\n", "base tick, ns", ns("tick_static"), ns("tick_dynamic"), ns("tick_static") / ns("tick_dynamic"));
+    printf("%-24s %10.2f %10.2f\n", "base ticks/s, millions", 1e3 / ns("tick_static"), 1e3 / ns("tick_dynamic"));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,263 @@
+// dispatch-bench, the base thread's per tick module dispatch on the host.
+//
+// N modules with a trivial update, every other one with a post update as a
+// Stepgen has, run three ways:
+//
+//      legacy      the e59029f pruThread walk (legacyThread.h)
+//      table       the flat task table walk alone, as executeModules() runs it
+//      pruThread   pruThread::update(), the table plus the port reader and
+//                  writer, rate groups and overrun check
+//
+// so legacy against table is the cost of the dispatch itself, and table
+// against pruThread the cost of the rest of the tick.
+//
+// Then the interrupt entry, from the platform's IRQ handler to the owner, the
+// Interrupt table (InvokeHandler, TimerInterrupt or ModuleInterrupt, virtual
+// timerTick) against the staticInterrupt.h templates (TimerIrq, and the QEI's
+// index IRQ, a ModuleIrq).
+//
+// Then the slowUpdate() rate groups, 12 slow tasks at 1 kHz, 500 Hz and 100 Hz
+// in a 40 kHz thread, with pruThread::setStaggerSlowUpdates() on and off. Each
+// tick of the 400 tick hyperperiod is timed on its own, best of many
+// hyperperiods so the host's noise drops out, and the worst of those ticks is
+// the figure the staggering is meant to cut.
+//
+//      dispatch-bench [passes]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "legacyThread.h"
+#include "interrupt/interrupt.h"
+#include "interrupt/staticInterrupt.h"
+#include "modules/module.h"
+#include "modules/moduleInterrupt.h"
+#include "modules/qei/qei.h"
+#include "thread/pruThread.h"
+#include "thread/timerInterrupt.h"
+#include "thread/virtualTimer.h"
+
+static const uint32_t moduleCounts[] = { 1, 4, 16, 64 };
+
+// IRQ numbers for the Interrupt table cases, unused by the host build
+static constexpr uint32_t timerIrq = 40;
+static constexpr uint32_t moduleIrq = 41;
+
+class LegacyWork : public Legacy::Module
+{
+public:
+    uint32_t count = 0;
+
+    LegacyWork(bool post) { usesModulePost = post; }
+    void update() override { count++; }
+    void updatePost() override { count++; }
+};
+
+class Work : public Module
+{
+public:
+    uint32_t count = 0;
+
+    Work(bool post)
+    {
+        usesModulePost = post;
+        bindTasks<Work>();
+    }
+    void update() override { count++; }
+    void updatePost() override { count++; }
+};
+
+// A slowUpdate() task with a fixed amount of work, as a PID loop would be
+static volatile uint32_t slowSink;
+static uint32_t slowRuns;
+
+class SlowWork : public Module
+{
+public:
+    SlowWork(int32_t threadFreq, int32_t slowFreq) : Module(threadFreq, slowFreq) { bindTasks<SlowWork>(); }
+    void slowUpdate() override
+    {
+        slowRuns++;
+        for (uint32_t i = 0; i < 200; i++) slowSink = slowSink + i;
+    }
+};
+
+static const int32_t slowFreqs[] = { 1000, 1000, 1000, 1000, 500, 500, 500, 500, 100, 100, 100, 100 };
+static constexpr uint32_t hyperperiod = Config::pruBaseFreq / 100;
+static constexpr uint32_t slowRepeats = 200;
+
+struct SlowResult {
+    double worstNs;         // the slowest tick of the hyperperiod, each tick best of the repeats
+    double meanNs;
+    uint32_t worstTasks;    // most slow tasks run on one tick
+};
+
+// Time each tick of the hyperperiod, best of repeats
+static SlowResult measureSlow(bool stagger, uint32_t repeats)
+{
+    pruThread thread("BaseThread");
+    thread.setTimer(std::make_unique<VirtualTimer>(Config::pruBaseFreq));
+    thread.setStaggerSlowUpdates(stagger);
+    for (int32_t slowFreq : slowFreqs) thread.registerModule(std::make_shared<SlowWork>(Config::pruBaseFreq, slowFreq));
+    thread.startThread();
+
+    std::vector<double> best(hyperperiod, 1e12);
+    std::vector<uint32_t> tasks(hyperperiod, 0);
+    for (uint32_t r = 0; r < repeats + 1; r++) {            // the first hyperperiod warms up
+        for (uint32_t t = 0; t < hyperperiod; t++) {
+            uint32_t runs = slowRuns;
+            auto start = std::chrono::steady_clock::now();
+            thread.update();
+            auto end = std::chrono::steady_clock::now();
+            if (!r) continue;
+            best[t] = std::min(best[t], std::chrono::duration<double, std::nano>(end - start).count());
+            tasks[t] = slowRuns - runs;
+        }
+    }
+
+    SlowResult result = { 0, 0, 0 };
+    for (uint32_t t = 0; t < hyperperiod; t++) {
+        result.worstNs = std::max(result.worstNs, best[t]);
+        result.meanNs += best[t] / hyperperiod;
+        result.worstTasks = std::max(result.worstTasks, tasks[t]);
+    }
+    return result;
+}
+
+// A timer with nothing behind it, the tick only counts
+class BenchTimer : public pruTimer
+{
+public:
+    uint32_t ticks = 0;
+
+    void configTimer() override {}
+    void startTimer() override {}
+    void stopTimer() override {}
+    void changeFrequency(uint32_t freq) override { frequency = freq; }
+    void timerTick() override { ticks++; }
+};
+
+int main(int argc, char* argv[])
+{
+    uint32_t passes = argc > 1 ? atoi(argv[1]) : 5;
+    if (passes == 0) {
+        printf("usage: %s [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // the same modules in the legacy walk, a flat table and a pruThread
+    struct Setup {
+        uint32_t modules;
+        Legacy::Thread legacy;
+        pruThread thread{"BaseThread"};
+        std::vector<ModuleTask> tasks, postTasks;     // the pruThread keeps the modules
+    };
+
+    std::vector<std::unique_ptr<Setup>> setups;
+    for (uint32_t modules : moduleCounts) {
+        auto setup = std::make_unique<Setup>();
+        setup->modules = modules;
+        setup->thread.setTimer(std::make_unique<VirtualTimer>(Config::pruBaseFreq));
+
+        for (uint32_t i = 0; i < modules; i++) {
+            bool post = i & 1;
+
+            auto legacyModule = std::make_shared<LegacyWork>(post);
+            setup->legacy.registerModule(legacyModule);
+            if (post) setup->legacy.registerModulePost(legacyModule);
+
+            auto module = std::make_shared<Work>(post);
+            setup->thread.registerModule(module);
+            if (post) setup->thread.registerModulePost(module);
+            setup->tasks.push_back(module->getUpdateTask());
+            if (post) setup->postTasks.push_back(module->getUpdatePostTask());
+        }
+        setup->legacy.startThread();
+        setup->thread.startThread();
+        setups.push_back(std::move(setup));
+    }
+
+    // the same timer, and the same QEI index handler, behind both IRQ paths
+    BenchTimer timer;
+    TimerInterrupt timerInterrupt(timerIrq, &timer);
+    TimerIrq<timerIrq, BenchTimer>::bind(&timer);
+
+    pruThread timebase("Base");
+    timebase.setTimer(std::make_unique<VirtualTimer>(Config::pruBaseFreq));
+    volatile uint16_t inputs = 0;
+    volatile float count, timestamp;
+    QEI qei(count, inputs, 0, GPIO_NOPULL, 0);     // binds QEI::IndexIrq<0>
+    qei.setIndexTimestamp(&timebase, &timestamp, nullptr, 1000);
+    ModuleInterrupt<QEI> moduleInterrupt(moduleIrq, &qei, &QEI::handleIndexInterrupt);
+
+    std::vector<Bench::Result> results;
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (auto& setup : setups) {
+            std::string suffix = "_" + std::to_string(setup->modules);
+            Setup& s = *setup;
+
+            Bench::keepBest(results, Bench::measure(("legacy" + suffix).c_str(), [&] { s.legacy.update(); }));
+            Bench::keepBest(results, Bench::measure(("table" + suffix).c_str(), [&] {
+                for (const ModuleTask& task : s.tasks) task.function(task.module);
+                for (const ModuleTask& task : s.postTasks) task.function(task.module);
+            }));
+            Bench::keepBest(results, Bench::measure(("pruThread" + suffix).c_str(), [&] { s.thread.update(); }));
+        }
+
+        Bench::keepBest(results, Bench::measure("timer_table", [] { Interrupt::InvokeHandler(timerIrq); }));
+        Bench::keepBest(results, Bench::measure("timer_static", [] { TimerIrq<timerIrq, BenchTimer>::handle(); }));
+        Bench::keepBest(results, Bench::measure("module_table", [] { Interrupt::InvokeHandler(moduleIrq); }));
+        Bench::keepBest(results, Bench::measure("module_static", [] { QEI::IndexIrq<0>::handle(); }));
+    }
+
+    // unstaggered and staggered
+    SlowResult slow[2] = { { 1e12, 1e12, 0 }, { 1e12, 1e12, 0 } };
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < 2; i++) {
+            SlowResult r = measureSlow(i, slowRepeats);
+            slow[i].worstNs = std::min(slow[i].worstNs, r.worstNs);
+            slow[i].meanNs = std::min(slow[i].meanNs, r.meanNs);
+            slow[i].worstTasks = r.worstTasks;
+        }
+    }
+
+    printf("\n## Dispatch, ns per tick, best of %lu passes\n", (unsigned long)passes);
+    printf("%8s %10s %10s %10s %16s\n", "modules", "legacy", "table", "pruThread", "table/legacy");
+    for (uint32_t modules : moduleCounts) {
+        std::string suffix = "_" + std::to_string(modules);
+        double ns[3] = {};
+        const char* names[3] = { "legacy", "table", "pruThread" };
+        for (int i = 0; i < 3; i++) {
+            for (const Bench::Result& r : results) {
+                if (r.name == names[i] + suffix) ns[i] = r.ns;
+            }
+        }
+        printf("%8lu %10.1f %10.1f %10.1f %15.2fx\n", (unsigned long)modules, ns[0], ns[1], ns[2], ns[1] / ns[0]);
+    }
+
+    printf("\n## Interrupt entry, ns per interrupt, best of %lu passes\n", (unsigned long)passes);
+    printf("%8s %10s %10s %16s\n", "owner", "table", "static", "static/table");
+    for (const char* owner : { "timer", "module" }) {
+        double ns[2] = {};
+        for (const Bench::Result& r : results) {
+            if (r.name == std::string(owner) + "_table") ns[0] = r.ns;
+            if (r.name == std::string(owner) + "_static") ns[1] = r.ns;
+        }
+        printf("%8s %10.2f %10.2f %15.2fx\n", owner, ns[0], ns[1], ns[1] / ns[0]);
+    }
+
+    printf("\n## Slow tasks, %lu in a %lu Hz thread, ns per tick, each tick best of %lu hyperperiods, best of %lu passes\n",
+           (unsigned long)(sizeof(slowFreqs) / sizeof(slowFreqs[0])), (unsigned long)Config::pruBaseFreq, (unsigned long)slowRepeats, (unsigned long)passes);
+    printf("%10s %12s %10s %20s\n", "stagger", "worst tick", "mean", "most tasks in a tick");
+    for (int i = 0; i < 2; i++) {
+        printf("%10s %12.1f %10.1f %20lu\n", i ? "on" : "off", slow[i].worstNs, slow[i].meanNs, (unsigned long)slow[i].worstTasks);
+    }
+
+    return EXIT_SUCCESS;
+}
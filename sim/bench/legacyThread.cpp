@@ -0,0 +1,71 @@
+#include "legacyThread.h"
+
+namespace Legacy {
+
+Module::Module()
+{
+	this->counter = 0;
+	this->updateCount = 1;
+}
+
+Module::Module(int32_t threadFreq, int32_t slowUpdateFreq) :
+	threadFreq(threadFreq),
+	slowUpdateFreq(slowUpdateFreq)
+{
+	this->counter = 0;
+	this->updateCount = this->threadFreq / this->slowUpdateFreq;
+}
+
+Module::~Module(){}
+
+void Module::runModule()
+{
+	++this->counter;
+
+	if (this->counter >= this->updateCount)
+	{
+		this->slowUpdate();
+		this->counter = 0;
+	}
+
+	this->update();
+}
+
+void Module::runModulePost()
+{
+	this->updatePost();
+}
+
+void Module::update(){}
+void Module::updatePost(){}
+void Module::slowUpdate(){}
+
+bool Thread::executeModules()
+{
+    for (const auto& module : modules) if (module) module->runModule();
+    if (hasModulesPost) for (const auto& module : modulesPost) if (module) module->runModulePost();
+    return true;
+}
+
+bool Thread::registerModule(std::shared_ptr<Module> module)
+{
+    if (!module) return false;
+    modules.push_back(module);
+    return true;
+}
+
+bool Thread::registerModulePost(std::shared_ptr<Module> module)
+{
+    if (!module) return false;
+    hasModulesPost = true;
+    modulesPost.push_back(module);
+    return true;
+}
+
+bool Thread::update()
+{
+    if (!isRunning() || isPaused()) return true;
+    return executeModules();
+}
+
+}
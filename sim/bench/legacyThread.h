@@ -0,0 +1,65 @@
+#ifndef LEGACYTHREAD_H
+#define LEGACYTHREAD_H
+
+// The module dispatch of pruThread before the flat task table (e59029f), kept
+// for dispatch-bench to compare against. Each tick walks the shared_ptr vectors
+// and calls runModule(), which counts to the slow update and makes the virtual
+// slowUpdate() and update() calls, then runModulePost() for the post modules.
+// The functions are in legacyThread.cpp, out of sight of the modules as
+// module.cpp and pruThread.cpp were.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Legacy {
+
+class Module
+{
+	protected:
+
+		int32_t threadFreq;
+		int32_t slowUpdateFreq;
+		int32_t updateCount;
+		int32_t counter;
+        bool usesModulePost = false;
+
+	public:
+
+		Module();
+		Module(int32_t, int32_t);
+
+		virtual ~Module();
+		void runModule();
+		void runModulePost();
+		virtual void update();
+		virtual void updatePost();
+		virtual void slowUpdate();
+
+        virtual bool getUsesModulePost() const { return usesModulePost; }
+};
+
+class Thread
+{
+private:
+    std::atomic<bool> threadRunning{false};
+    std::atomic<bool> threadPaused{false};
+    std::vector<std::shared_ptr<Module>> modules;
+    std::vector<std::shared_ptr<Module>> modulesPost;
+    bool hasModulesPost = false;
+
+    bool executeModules();
+
+public:
+    bool registerModule(std::shared_ptr<Module> module);
+    bool registerModulePost(std::shared_ptr<Module> module);
+    bool isRunning() const { return threadRunning.load(std::memory_order_acquire); }
+    bool isPaused() const { return threadPaused.load(std::memory_order_acquire); }
+    void startThread() { threadRunning.store(true, std::memory_order_release); }
+    bool update();
+};
+
+}
+
+#endif
@@ -0,0 +1,163 @@
+// module-bench, the cost of the module hot paths on the host.
+//
+// Each module's per-tick call is run against the simulated HAL, whose Pin
+// counts every access. See bench.h for what is measured and how it is compared.
+//
+//      module-bench [--baseline file] [--write file] [--tolerance percent] [--no-time] [--filter text] [--passes n]
+//
+// make bench compares against sim/bench/baseline.txt and fails when a module
+// is more than 25% slower, or makes more GPIO accesses (or instructions, where
+// the host counts them) than the baseline, make bench-baseline rewrites it.
+// Times in the baseline are from the machine that wrote it, re-baseline on a
+// quiet machine before relying on the time gate there, or pass --no-time
+// (make bench BENCH_FLAGS=--no-time) to gate on the counts alone.
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "bench.h"
+#include "data.h"
+#include "modules/comms/commsHandler.h"
+#include "modules/digitalPin/digitalPin.h"
+#include "modules/qei/qei.h"
+#include "modules/sigmaDelta/sigmaDelta.h"
+#include "modules/softEncoder/softEncoder.h"
+#include "modules/stepgen/stepgen.h"
+#include "modules/stepgenBank/stepgenBank.h"
+#include "sensors/thermistor/thermistor.h"
+#include "thread/portReader.h"
+#include "thread/portWriter.h"
+#include "remora-hal/analogIn/analogIn.h"
+#include "remora-hal/hardware_qei/hardware_qei.h"
+#include "remora-hal/pin/pin.h"
+
+static constexpr int32_t baseFreq = Config::pruBaseFreq;
+
+// Moves an encoder's A and B inputs one quadrature edge per call by writing the
+// simulated port directly, so the stimulus is not counted as GPIO traffic
+class Quadrature
+{
+private:
+    Pin::Port* port;
+    uint32_t maskA, maskB;
+    uint32_t phase = 0;
+
+public:
+    Quadrature(const char* pinA, const char* pinB)
+    {
+        Pin a(pinA, INPUT), b(pinB, INPUT);
+        port = (Pin::Port*)a.getPort();
+        maskA = a.getPinMask();
+        maskB = b.getPinMask();
+    }
+
+    void step()
+    {
+        phase = (phase + 1) & 3;
+        port->level &= ~(maskA | maskB);
+        if (phase == 1 || phase == 2) port->level |= maskA;
+        if (phase >= 2) port->level |= maskB;
+    }
+};
+
+// Every benchmark, options.passes times, keeping the best of each in results
+static void runSuite(const Bench::Options& options, std::vector<Bench::Result>& results)
+{
+    auto run = [&](const char* name, auto&& call) {
+        if (Bench::selected(options, name)) Bench::keepBest(results, Bench::measure(name, call));
+    };
+
+    for (uint32_t pass = 0; pass < options.passes; pass++) {
+        // Stepgen::makePulses() and stopPulses(), one tick at 10 kHz of a 40 kHz thread
+        {
+            rxData.jointFreqCmd[0] = 10000;
+            rxData.jointEnable = 0x01;
+            Stepgen stepgen(baseFreq, 0, "PA_0", "PA_1", "PA_2", Config::ddsResolutionBits,
+                            rxData.jointFreqCmd[0], txData.jointFeedback[0], rxData.jointEnable, true);
+            run("Stepgen.tick", [&] { stepgen.update(); stepgen.updatePost(); });
+
+            PortWriter writer;
+            stepgen.setPortWriter(&writer);
+            run("Stepgen.tick_PortWriter", [&] { stepgen.update(); writer.flush(); stepgen.updatePost(); writer.flush(); });
+        }
+
+        // StepgenBank, four joints at 10 kHz
+        {
+            for (int i = 0; i < 4; i++) rxData.jointFreqCmd[i] = 10000 - 2000 * i;
+            rxData.jointEnable = 0x0F;
+            StepgenBank bank(baseFreq, Config::ddsResolutionBits, rxData, txData);
+            bank.addJoint(0, "PB_0", "PB_1", "PB_2");
+            bank.addJoint(1, "PB_0", "PB_3", "PB_4");
+            bank.addJoint(2, "PB_0", "PB_5", "PB_6");
+            bank.addJoint(3, "PB_0", "PB_7", "PB_8");
+            run("StepgenBank.tick_4_joints", [&] { bank.update(); bank.updatePost(); });
+        }
+
+        // SoftEncoder::update() with the inputs still and moving one edge per call
+        {
+            SoftEncoder encoder(txData.processVariable[0], "PC_0", "PC_1", NONE);
+            Quadrature signal("PC_0", "PC_1");
+            run("SoftEncoder.update_idle", [&] { encoder.update(); });
+            run("SoftEncoder.update_moving", [&] { signal.step(); encoder.update(); });
+
+            PortReader reader;
+            encoder.setPortReader(&reader);
+            run("SoftEncoder.update_moving_PortReader", [&] { signal.step(); reader.sample(); encoder.update(); });
+        }
+
+        // SigmaDelta::update() at 37.5%
+        {
+            volatile float setPoint = 37.5f;
+            SigmaDelta sigmaDelta("PC_4", &setPoint);
+            run("SigmaDelta.update", [&] { sigmaDelta.update(); });
+        }
+
+        // DigitalPin::update() as an output and as an input
+        {
+            rxData.outputs = 0x0001;
+            DigitalPin output(rxData.outputs, 1, "PE_0", 0, false, NONE);
+            run("DigitalPin.update_output", [&] { output.update(); });
+
+            DigitalPin input(txData.inputs, 0, "PE_1", 0, false, PULLUP);
+            run("DigitalPin.update_input", [&] { input.update(); });
+        }
+
+        // QEI::update() with the counter moving
+        {
+            QEI qei(txData.processVariable[1], GPIO_NOPULL, 0);
+            Hardware_QEI* counter = Hardware_QEI::find(0);
+            run("QEI.update", [&] { counter->move(3); qei.update(); });
+        }
+
+        // Thermistor::adcValueToTemperature(), beta model
+        {
+            AnalogIn::drive("PF_0", 30000);
+            Thermistor thermistor("PF_0", 3950.0f, 100000, 25);
+            volatile float temperature;
+            run("Thermistor.adcValueToTemperature", [&] { temperature = thermistor.adcValueToTemperature(); });
+        }
+
+        // CommsHandler::update(), data arriving every other call
+        {
+            CommsHandler comms;
+            bool data = false;
+            run("CommsHandler.update", [&] { data = !data; comms.setData(data); comms.update(); });
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Bench::Options options;
+    if (!Bench::parseOptions(argc, argv, options)) return 2;
+
+    std::vector<Bench::Result> results;
+    for (uint32_t attempt = 0; attempt < options.attempts; attempt++) {
+        if (attempt) printf("Times beyond the tolerance, running the suite again\n");
+        runSuite(options, results);
+        if (!Bench::retry(options, results)) break;
+    }
+
+    return Bench::finish(options, results);
+}
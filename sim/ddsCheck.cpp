@@ -0,0 +1,163 @@
+// remora-dds-check, the Stepgen and StepgenBank step counts against an exact
+// model through thread retimes.
+//
+// Each joint runs at a fixed frequency through segments of base ticks at
+// different thread frequencies, retimed between segments as pruThread does.
+// The exact position is the sum of frequency * ticks / threadFreq over the
+// segments, kept as a fraction. The exact integer DDS counts floor(position)
+// however long it runs and however it is retimed, with one step edge per
+// count, a drift of a single step fails the check.
+//
+// The check runs with whole Hz commands, and again with 8 command fraction bits
+// and commands with a fraction.
+//
+//      remora-dds-check [seconds per segment]
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data.h"
+#include "modules/stepgen/stepgen.h"
+#include "modules/stepgenBank/stepgenBank.h"
+#include "remora-hal/pin/pin.h"
+
+typedef __int128 int128;
+
+// Thread frequencies in turn, the first is the one the modules start at.
+// The joint frequencies stay below the slowest, one step per tick.
+static const int32_t threadFreqs[] = { 40000, 30000, 48000, 35000, 40000 };
+static const int32_t jointFreqs[] = { 1, 7, 1000, 12345, 29999, -3, -2500, -29999 };
+static constexpr uint32_t jointCount = sizeof(jointFreqs) / sizeof(jointFreqs[0]);
+
+static_assert(jointCount <= Config::joints, "more joints than the config has");
+
+// The exact position in steps, num / den
+struct Position {
+    int128 num = 0;
+    int128 den = 1;
+
+    // frequency / 2^fractionBits steps per second
+    void add(int64_t frequency, uint32_t fractionBits, uint64_t ticks, int32_t threadFreq)
+    {
+        int128 scale = (int128)threadFreq << fractionBits;
+        num = num * scale + (int128)frequency * (int128)ticks * den;
+        den *= scale;
+        // keep den small, threadFreqs share large factors
+        int128 a = num < 0 ? -num : num, b = den;
+        while (b) { int128 t = a % b; a = b; b = t; }
+        if (a > 1) { num /= a; den /= a; }
+    }
+
+    // count - position, in steps
+    double error(int64_t count) const { return (double)((int128)count * den - num) / (double)den; }
+};
+
+static std::string pinName(char port, uint32_t pin)
+{
+    return std::string("P") + port + "_" + std::to_string(pin);
+}
+
+// One run of every segment, the Stepgens on ports from firstPort and the bank
+// on the three after them. True when every count matches the model.
+static bool check(uint32_t fractionBits, char firstPort, double seconds)
+{
+    const char stepPort = firstPort, directionPort = firstPort + 1, bankStepPort = firstPort + 3, bankDirectionPort = firstPort + 4;
+    const std::string enable = pinName(firstPort + 2, 0), bankEnable = pinName(firstPort + 2, 1);
+
+    // a Stepgen per joint, and a StepgenBank with the same joints
+    static rxData_t bankRx;
+    static txData_t bankTx;
+    std::vector<std::string> names;
+    names.reserve(2 * jointCount);
+    std::vector<std::unique_ptr<Stepgen>> stepgens;
+
+    int32_t commands[jointCount];
+    for (uint32_t i = 0; i < jointCount; i++) {
+        // a fraction below the whole Hz, the same sign as the command
+        int32_t fraction = fractionBits ? (int32_t)((37 * i + 11) % (1u << fractionBits)) : 0;
+        commands[i] = jointFreqs[i] * (1 << fractionBits) + (jointFreqs[i] < 0 ? -fraction : fraction);
+    }
+
+    rxData.jointEnable = bankRx.jointEnable = (jointMask_t)((1u << jointCount) - 1);
+    StepgenBank bank(threadFreqs[0], Config::ddsResolutionBits, bankRx, bankTx);
+    bank.setCommandFractionBits(fractionBits);
+
+    for (uint32_t i = 0; i < jointCount; i++) {
+        rxData.jointFreqCmd[i] = bankRx.jointFreqCmd[i] = commands[i];
+
+        names.push_back(pinName(stepPort, i));
+        const char* step = names.back().c_str();
+        names.push_back(pinName(directionPort, i));
+        const char* direction = names.back().c_str();
+        stepgens.push_back(std::make_unique<Stepgen>(threadFreqs[0], i, enable.c_str(), step, direction, Config::ddsResolutionBits,
+                                                     rxData.jointFreqCmd[i], txData.jointFeedback[i], rxData.jointEnable, true));
+        stepgens.back()->setCommandFractionBits(fractionBits);
+
+        bank.addJoint(i, bankEnable.c_str(), pinName(bankStepPort, i).c_str(), pinName(bankDirectionPort, i).c_str());
+    }
+
+    Position position[jointCount];
+    bool pass = true;
+    double worst = 0;
+
+    printf("\n## DDS check, %g s per segment, %lu command fraction bits\n", seconds, (unsigned long)fractionBits);
+    for (uint32_t segment = 0; segment < sizeof(threadFreqs) / sizeof(threadFreqs[0]); segment++) {
+        int32_t threadFreq = threadFreqs[segment];
+        if (segment) {
+            for (auto& stepgen : stepgens) stepgen->changeThreadFreq(threadFreq);
+            bank.changeThreadFreq(threadFreq);
+        }
+
+        // an odd tick count, so a retime lands part way through a step
+        uint64_t ticks = (uint64_t)(seconds * threadFreq) + 2 * segment + 1;
+        for (uint64_t t = 0; t < ticks; t++) {
+            for (auto& stepgen : stepgens) {
+                stepgen->update();
+                stepgen->updatePost();
+            }
+            bank.update();
+            bank.updatePost();
+        }
+
+        for (uint32_t i = 0; i < jointCount; i++) {
+            position[i].add(commands[i], fractionBits, ticks, threadFreq);
+
+            int64_t counts[2] = { txData.jointFeedback[i], bankTx.jointFeedback[i] };
+            uint64_t edges[2] = { Pin::risingEdges(pinName(stepPort, i)), Pin::risingEdges(pinName(bankStepPort, i)) };
+            for (int m = 0; m < 2; m++) {
+                double error = position[i].error(counts[m]);
+                bool ok = error > -1.0 && error <= 0.0 && edges[m] == (uint64_t)llabs(counts[m]);
+                if (!ok) {
+                    printf("%s joint %lu %6ld/%lu Hz at %ld Hz: count %lld, %+.6f steps from the model, step edges %llu MISMATCH\n",
+                           m ? "StepgenBank" : "Stepgen", (unsigned long)i, (long)commands[i], 1ul << fractionBits, (long)threadFreq,
+                           (long long)counts[m], error, (unsigned long long)edges[m]);
+                }
+                if (error < 0) error = -error;
+                if (error > worst) worst = error;
+                pass = pass && ok;
+            }
+        }
+        printf("Segment %lu, %llu ticks at %ld Hz, furthest below the model so far %.6f steps\n",
+               (unsigned long)segment, (unsigned long long)ticks, (long)threadFreq, worst);
+    }
+
+    return pass;
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 10.0;
+    if (seconds <= 0) {
+        printf("usage: %s [seconds per segment]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool pass = check(0, 'A', seconds);
+    pass = check(8, 'F', seconds) && pass;
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
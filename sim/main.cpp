@@ -0,0 +1,180 @@
+// remora-sim, remora-core run as a Linux program.
+//
+// The threads run on VirtualTimers and the HAL is simulated (sim/remora-hal).
+// SimComms stands in for the host: once per servo period it sends a packet of
+// joint commands, reads the feedback back and moves virtual time on by one
+// servo period. After the requested virtual seconds it prints a summary and
+// exits, non-zero when the step counts are not what was commanded.
+//
+//      remora-sim [seconds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "remora.h"
+#include "comms/commsInterface.h"
+#include "comms/packetLayout.h"
+#include "modules/comms/commsHandler.h"
+#include "thread/cycleCounter.h"
+#include "thread/virtualPulseOutput.h"
+#include "thread/virtualTimer.h"
+#include "remora-hal/pin/pin.h"
+
+// The host's steady clock as the cycle counter, times the thread ticks in
+// real nanoseconds
+class HostCycleCounter : public CycleCounter {
+public:
+    void init() override {}
+
+    uint32_t getCycles() const override
+    {
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    uint32_t getFrequency() const override { return 1000000000; }
+};
+
+// The joints of staticConfigExample.h, step pins and the commanded frequencies
+struct SimJoint {
+    const char* stepPin;
+    int32_t frequency;      // steps per second
+};
+
+static const SimJoint simJoints[] = {
+    { "PA_1",  1000 },
+    { "PA_3", -2500 },
+    { "PA_5", 12345 },
+};
+static constexpr uint32_t simJointCount = sizeof(simJoints) / sizeof(simJoints[0]);
+
+class SimComms : public CommsInterface {
+private:
+    uint64_t durationNs;
+    uint64_t packetPeriodNs = 1000000;
+    const VirtualTimer* baseTimer = nullptr;
+    uint32_t baseFreq = 0;
+    uint64_t packets = 0;
+    uint64_t rejected = 0;
+    txData_t feedback;                  // the last packet sent back, as the host sees it
+    std::chrono::steady_clock::time_point wallStart;
+
+    void sendPacket()
+    {
+        rxData_t packet;
+        packet.header = Config::pruData;
+        for (uint32_t i = 0; i < simJointCount; i++) packet.jointFreqCmd[i] = simJoints[i].frequency;
+        packet.jointEnable = (1 << simJointCount) - 1;
+        packet.outputs = (VirtualTimer::getTime() / 500000000) & 1;     // PB_0 toggled every 0.5 s
+
+        if (unpackRx((const uint8_t*)packet.rxBuffer, packetLayout.getRxSize())) {
+            if (dataCallback) dataCallback(true);
+            packets++;
+        } else {
+            rejected++;
+        }
+
+        packTx((uint8_t*)feedback.txBuffer);
+    }
+
+    void finish()
+    {
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        double virtualSeconds = VirtualTimer::getTime() / 1e9;
+        uint64_t baseTicks = baseTimer->getTickCount();
+        bool pass = rejected == 0;
+
+        packTx((uint8_t*)feedback.txBuffer);      // the feedback at the end of the run
+
+        printf("\n## Simulation summary\n");
+        printf("Virtual time %.3f s in %.3f s wall, %.1fx real time\n", virtualSeconds, wallSeconds, virtualSeconds / wallSeconds);
+        printf("Base ticks %llu, packets %llu, rejected %llu\n", (unsigned long long)baseTicks, (unsigned long long)packets, (unsigned long long)rejected);
+
+        for (uint32_t i = 0; i < simJointCount; i++) {
+            int64_t expected = (int64_t)simJoints[i].frequency * (int64_t)baseTicks / baseFreq;
+            int32_t position = feedback.jointFeedback[i];
+            uint32_t edges = Pin::risingEdges(simJoints[i].stepPin);
+            bool ok = llabs(expected - position) <= 1 && (int64_t)edges == llabs(position);
+            pass = pass && ok;
+            printf("Joint %lu %6ld Hz: expected %lld steps, feedback %ld, step edges %lu %s\n",
+                   (unsigned long)i, (long)simJoints[i].frequency, (long long)expected, (long)position, (unsigned long)edges, ok ? "ok" : "MISMATCH");
+        }
+
+        printf("Output PB_0 edges %lu, inputs 0x%04x\n", (unsigned long)Pin::risingEdges("PB_0"), (unsigned)feedback.inputs);
+
+        const Pin::Counters& counters = Pin::getCounters();
+        printf("GPIO per base tick: set %.2f, get %.2f, writePort %.2f, readPort %.2f\n",
+               (double)counters.set / baseTicks, (double)counters.get / baseTicks,
+               (double)counters.writePort / baseTicks, (double)counters.readPort / baseTicks);
+
+        printf("%s\n", pass ? "PASS" : "FAIL");
+        fflush(stdout);
+        exit(pass ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+public:
+    SimComms(volatile rxData_t* rx, volatile txData_t* tx, uint64_t _durationNs)
+        : durationNs(_durationNs),
+          wallStart(std::chrono::steady_clock::now())
+    {
+        ptrRxData = rx;
+        ptrTxData = tx;
+    }
+
+    void setTiming(const VirtualTimer* _baseTimer, uint32_t _baseFreq, uint32_t servoFreq)
+    {
+        baseTimer = _baseTimer;
+        baseFreq = _baseFreq;
+        packetPeriodNs = 1000000000ULL / servoFreq;
+    }
+
+    // the main loop, one packet per servo period
+    void tasks() override
+    {
+        sendPacket();
+        VirtualTimer::run(packetPeriodNs);
+
+        // an input from the machine, PB_1 pulled low after one second
+        if (VirtualTimer::getTime() >= 1000000000ULL) Pin::drive("PB_1", false);
+
+        if (VirtualTimer::getTime() >= durationNs) finish();
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+    if (seconds <= 0) {
+        printf("usage: %s [seconds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto simComms = std::make_unique<SimComms>(&rxData, &txData, (uint64_t)(seconds * 1e9));
+    SimComms* sim = simComms.get();
+    auto commsHandler = std::make_shared<CommsHandler>();
+    commsHandler->setInterface(std::move(simComms));
+
+    auto baseTimer = std::make_unique<VirtualTimer>(Config::pruBaseFreq);
+    auto servoTimer = std::make_unique<VirtualTimer>(Config::pruServoFreq);
+    VirtualTimer* base = baseTimer.get();
+
+    TimerFactory timerFactory = [](const char*, uint32_t frequency, uint32_t) -> std::unique_ptr<pruTimer> {
+        return std::make_unique<VirtualTimer>(frequency);
+    };
+
+    Remora* remora = new Remora(commsHandler, std::move(baseTimer), std::move(servoTimer), nullptr,
+                                std::make_unique<HostCycleCounter>(), timerFactory);
+
+    remora->setPulseOutputFactory([](const char*) -> std::unique_ptr<PulseOutput> {
+        return std::make_unique<VirtualPulseOutput>(100000000);
+    });
+
+    // the frequencies the static config set
+    sim->setTiming(base, remora->getBaseFreq(), remora->getServoFreq());
+
+    remora->run();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#ifndef ARDUINOJSON_SHIM_H
+#define ARDUINOJSON_SHIM_H
+
+// Enough of the ArduinoJson interface for remora-core to compile on the host.
+// Every document is empty, the host build takes its threads and modules from a
+// static config (REMORA_STATIC_CONFIG) and never parses JSON.
+
+#include <cstddef>
+
+class JsonVariant
+{
+private:
+    // The empty value, passed through an empty asm so GCC does not fold the
+    // null strings into the modules' create() and warn about the printf and
+    // std::string calls there, which only the target reaches, with parsed values
+    template <typename T> static T empty()
+    {
+        T value = T();
+        asm volatile("" : : "r"(&value) : "memory");
+        return value;
+    }
+
+public:
+    template <typename T> bool is() const { return false; }
+    template <typename T> T as() const { return empty<T>(); }
+    template <typename T> operator T() const { return empty<T>(); }
+    template <typename T> T operator|(T fallback) const { return fallback; }
+    template <typename T> JsonVariant& operator=(const T&) { return *this; }
+
+    JsonVariant operator[](const char*) const { return JsonVariant(); }
+    JsonVariant operator[](size_t) const { return JsonVariant(); }
+    JsonVariant operator[](int) const { return JsonVariant(); }
+
+    bool isNull() const { return true; }
+};
+
+typedef JsonVariant JsonObject;
+
+class JsonArray : public JsonVariant
+{
+public:
+    using JsonVariant::operator=;
+
+    typedef JsonVariant* iterator;
+    iterator begin() const { return nullptr; }
+    iterator end() const { return nullptr; }
+    size_t size() const { return 0; }
+};
+
+class JsonDocument : public JsonVariant
+{
+public:
+    void clear() {}
+};
+
+class DeserializationError
+{
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code code = EmptyInput) : value(code) {}
+    Code code() const { return value; }
+    const char* c_str() const { return "EmptyInput"; }
+    explicit operator bool() const { return value != Ok; }
+
+private:
+    Code value;
+};
+
+template <typename Input>
+inline DeserializationError deserializeJson(JsonDocument&, const Input&) { return DeserializationError(); }
+
+#endif
@@ -0,0 +1,10 @@
+#include "fatfs.h"
+
+FATFS SDFatFS;
+char SDPath[4];
+FIL SDFile;
+
+FRESULT f_mount(FATFS*, const TCHAR*, unsigned char) { return FR_NOT_READY; }
+FRESULT f_open(FIL*, const TCHAR*, unsigned char) { return FR_NO_FILE; }
+FRESULT f_read(FIL*, void*, UINT, UINT* br) { *br = 0; return FR_NOT_READY; }
+FRESULT f_close(FIL*) { return FR_OK; }
@@ -0,0 +1,33 @@
+#ifndef FATFS_H
+#define FATFS_H
+
+// No SD card on the host, f_mount fails and the JSON config is not read from
+// one. Only the calls remora-core makes are declared.
+
+typedef char TCHAR;
+typedef unsigned int UINT;
+typedef unsigned long FSIZE_t;
+
+typedef struct { int unused; } FATFS;
+typedef struct { FSIZE_t fsize; } FIL;
+
+typedef enum {
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_NOT_READY = 3,
+    FR_NO_FILE = 4
+} FRESULT;
+
+#define FA_READ 0x01
+
+extern FATFS SDFatFS;
+extern char SDPath[4];
+extern FIL SDFile;
+
+FRESULT f_mount(FATFS* fs, const TCHAR* path, unsigned char opt);
+FRESULT f_open(FIL* fp, const TCHAR* path, unsigned char mode);
+FRESULT f_read(FIL* fp, void* buff, UINT btr, UINT* br);
+FRESULT f_close(FIL* fp);
+#define f_size(fp) ((fp)->fsize)
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef HARDWARE_H
+#define HARDWARE_H
+
+// simulated IRQs, the Interrupt vector table size
+#define PERIPH_COUNT_IRQn 64
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef IRQHANDLERS_H
+#define IRQHANDLERS_H
+
+#include "remora-core/modules/qei/qei.h"
+
+// The host build has no vector table, the VirtualTimers dispatch their own ticks.
+// The simulated QEI raises its index IRQ through Hardware_QEI::indexIrqHandlers.
+
+template <uint32_t... Instance>
+static bool installQeiIndexIrqs()
+{
+    ((Hardware_QEI::indexIrqHandlers[Instance] = &QEI::IndexIrq<Instance>::handle), ...);
+    return true;
+}
+
+static const bool qeiIndexIrqsInstalled = installQeiIndexIrqs<0, 1, 2, 3>();
+static_assert(QEI::indexIrqs == Hardware_QEI::maxInstances, "an index IRQ per simulated QEI");
+
+#endif
@@ -0,0 +1,29 @@
+#include "analogIn.h"
+
+#include <cstdio>
+
+AnalogIn::AnalogIn(const std::string& portAndPin)
+    : channel(find(portAndPin))
+{
+    if (!channel) printf("Sim: no free ADC channel for %s\n", portAndPin.c_str());
+}
+
+// The pin's channel, added on first use
+AnalogIn::Channel* AnalogIn::find(const std::string& portAndPin)
+{
+    for (uint32_t i = 0; i < channelCount; i++) {
+        if (channels[i].portAndPin == portAndPin) return &channels[i];
+    }
+    if (channelCount == maxChannels) return nullptr;
+
+    channels[channelCount] = { portAndPin, 0 };
+    return &channels[channelCount++];
+}
+
+bool AnalogIn::drive(const std::string& portAndPin, uint16_t value)
+{
+    Channel* channel = find(portAndPin);
+    if (!channel) return false;
+    channel->value = value;
+    return true;
+}
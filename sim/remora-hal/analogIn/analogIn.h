@@ -0,0 +1,41 @@
+#ifndef ANALOGIN_H
+#define ANALOGIN_H
+
+#include <cstdint>
+#include <string>
+
+// An ADC input with no hardware behind it. The simulation sets the value a
+// pin reads with AnalogIn::drive(), full scale is 16 bits as on target.
+class AnalogIn
+{
+private:
+    struct Channel {
+        std::string portAndPin;
+        uint16_t value;
+    };
+
+    static constexpr uint32_t maxChannels = 16;
+    static inline Channel channels[maxChannels] = {};
+    static inline uint32_t channelCount = 0;
+    static inline uint64_t reads = 0;
+
+    Channel* channel;
+
+    static Channel* find(const std::string& portAndPin);
+
+public:
+    AnalogIn(const std::string& portAndPin);
+
+    unsigned int read()
+    {
+        reads++;
+        return channel ? channel->value : 0;
+    }
+
+    // The simulation side, not part of the HAL interface
+    static bool drive(const std::string& portAndPin, uint16_t value);     // false when the channels are full
+    static uint64_t getReads() { return reads; }
+    static void resetReads() { reads = 0; }
+};
+
+#endif
@@ -0,0 +1,24 @@
+#include "hardware_pwm.h"
+
+#include <algorithm>
+
+HardwarePWM::HardwarePWM(int period, int pulseWidth, const std::string& pin)
+    : pin(pin),
+      period(period),
+      pulseWidth(pulseWidth)
+{
+    outputs.push_back(this);
+}
+
+HardwarePWM::~HardwarePWM()
+{
+    outputs.erase(std::remove(outputs.begin(), outputs.end(), this), outputs.end());
+}
+
+HardwarePWM* HardwarePWM::find(const std::string& pin)
+{
+    for (HardwarePWM* output : outputs) {
+        if (output->pin == pin) return output;
+    }
+    return nullptr;
+}
@@ -0,0 +1,31 @@
+#ifndef HARDWARE_PWM_H
+#define HARDWARE_PWM_H
+
+#include <string>
+#include <vector>
+
+// A timer PWM output with no hardware behind it. The period and pulse width
+// last written are kept so the simulation can check them.
+class HardwarePWM
+{
+private:
+    static inline std::vector<HardwarePWM*> outputs;
+
+    std::string pin;
+    int period;             // us
+    int pulseWidth;
+
+public:
+    HardwarePWM(int period, int pulseWidth, const std::string& pin);
+    ~HardwarePWM();
+
+    void change_period(int _period) { period = _period; }
+    void change_pulsewidth(int _pulseWidth) { pulseWidth = _pulseWidth; }
+
+    // The simulation side, not part of the HAL interface
+    int getPeriod() const { return period; }
+    int getPulseWidth() const { return pulseWidth; }
+    static HardwarePWM* find(const std::string& pin);      // nullptr when no PWM drives the pin
+};
+
+#endif
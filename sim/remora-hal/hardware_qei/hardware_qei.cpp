@@ -0,0 +1,42 @@
+#include "hardware_qei.h"
+
+#include <cstdio>
+
+Hardware_QEI::Hardware_QEI(bool hasIndex, int modifier)
+    : Hardware_QEI(hasIndex, modifier, 0)
+{
+}
+
+Hardware_QEI::Hardware_QEI(bool hasIndex, int modifier, int instance)
+    : instance(instance),
+      hasIndex(hasIndex),
+      counterBits(32)
+{
+    (void)modifier;
+    if (instance >= 0 && instance < (int)maxInstances) instances[instance] = this;
+    else printf("Sim: QEI instance %d is out of range\n", instance);
+}
+
+Hardware_QEI::~Hardware_QEI()
+{
+    if (instance >= 0 && instance < (int)maxInstances && instances[instance] == this) instances[instance] = nullptr;
+}
+
+void Hardware_QEI::move(int32_t counts)
+{
+    count += (uint32_t)counts;
+    if (counterBits < 32) count &= (1u << counterBits) - 1;
+}
+
+void Hardware_QEI::index()
+{
+    if (!hasIndex) return;
+    indexCount = (int32_t)count;
+    indexDetected = true;
+    if (instance >= 0 && instance < (int)maxInstances && indexIrqHandlers[instance]) indexIrqHandlers[instance]();
+}
+
+Hardware_QEI* Hardware_QEI::find(int instance)
+{
+    return instance >= 0 && instance < (int)maxInstances ? instances[instance] : nullptr;
+}
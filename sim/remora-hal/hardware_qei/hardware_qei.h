@@ -0,0 +1,43 @@
+#ifndef HARDWARE_QEI_H
+#define HARDWARE_QEI_H
+
+#include <cstdint>
+
+// A quadrature encoder counter with no hardware behind it. The simulation
+// moves the count and raises the index, the count wraps at counterBits as the
+// hardware counter would.
+class Hardware_QEI
+{
+public:
+    static constexpr uint32_t maxInstances = 4;
+
+private:
+    static inline Hardware_QEI* instances[maxInstances] = {};
+
+    int instance;
+    bool hasIndex;
+    uint32_t counterBits;
+    uint32_t count = 0;
+
+public:
+    // The simulated index IRQ vector, one per instance, set by the project's
+    // irqHandlers.h and raised by index()
+    static inline void (*indexIrqHandlers[maxInstances])() = {};
+
+    volatile bool indexDetected = false;
+    volatile int32_t indexCount = 0;
+
+    Hardware_QEI(bool hasIndex, int modifier);
+    Hardware_QEI(bool hasIndex, int modifier, int instance);
+    ~Hardware_QEI();
+
+    uint32_t get() { return count; }
+
+    // The simulation side, not part of the HAL interface
+    void setCounterBits(uint32_t bits) { counterBits = bits; }
+    void move(int32_t counts);
+    void index();                       // the index pulse, latches the count and raises the index IRQ
+    static Hardware_QEI* find(int instance);   // nullptr when the instance is not in use
+};
+
+#endif
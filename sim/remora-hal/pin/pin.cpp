@@ -0,0 +1,108 @@
+#include "pin.h"
+
+#include <cstdio>
+
+Pin::Pin(const std::string& portAndPin, int dir, int modifier)
+    : portAndPin(portAndPin),
+      dir(dir),
+      modifier(modifier)
+{
+    if (!parse(portAndPin, port, pinNumber)) {
+        printf("Sim: invalid pin name %s, the pin is not connected\n", portAndPin.c_str());
+        return;
+    }
+    pinMask = 1u << pinNumber;
+
+    if (dir == OUTPUT) setAsOutput();
+    else setAsInput();
+}
+
+// "PA_0" to "PP_15"
+bool Pin::parse(const std::string& portAndPin, Port*& port, uint32_t& pinNumber)
+{
+    if (portAndPin.size() < 4 || portAndPin[0] != 'P' || portAndPin[2] != '_') return false;
+
+    uint32_t index = portAndPin[1] - 'A';
+    if (index >= portCount) return false;
+
+    uint32_t number = 0;
+    for (size_t i = 3; i < portAndPin.size(); i++) {
+        char c = portAndPin[i];
+        if (c < '0' || c > '9') return false;
+        number = number * 10 + (c - '0');
+    }
+    if (number > 15) return false;
+
+    port = &ports[index];
+    pinNumber = number;
+    return true;
+}
+
+void Pin::setAsOutput()
+{
+    dir = OUTPUT;
+    if (port) port->output |= pinMask;
+}
+
+void Pin::setAsInput()
+{
+    dir = INPUT;
+    if (!port) return;
+    port->output &= ~pinMask;
+
+    // an undriven input reads its pull
+    if (modifier == PULLUP) write(port, pinMask, 0);
+}
+
+void Pin::setPullUp()
+{
+    modifier = PULLUP;
+    if (port && dir == INPUT) write(port, pinMask, 0);
+}
+
+void Pin::setPullDown()
+{
+    modifier = PULLDOWN;
+    if (port && dir == INPUT) write(port, 0, pinMask);
+}
+
+void Pin::setPullNone()
+{
+    modifier = PULLNONE;
+}
+
+void Pin::setOpenDrain()
+{
+    modifier = OPENDRAIN;
+}
+
+bool Pin::drive(const std::string& portAndPin, bool level)
+{
+    Port* port;
+    uint32_t pinNumber;
+    if (!parse(portAndPin, port, pinNumber)) return false;
+
+    uint32_t mask = 1u << pinNumber;
+    if (level) write(port, mask, 0);
+    else write(port, 0, mask);
+    return true;
+}
+
+bool Pin::level(const std::string& portAndPin)
+{
+    Port* port;
+    uint32_t pinNumber;
+    return parse(portAndPin, port, pinNumber) && (port->level & (1u << pinNumber));
+}
+
+uint32_t Pin::risingEdges(const std::string& portAndPin)
+{
+    Port* port;
+    uint32_t pinNumber;
+    return parse(portAndPin, port, pinNumber) ? port->rises[pinNumber] : 0;
+}
+
+void Pin::resetPorts()
+{
+    for (Port& port : ports) port = {};
+}
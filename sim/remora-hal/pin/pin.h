@@ -0,0 +1,119 @@
+#ifndef PIN_H
+#define PIN_H
+
+#include <cstdint>
+#include <string>
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+
+#define GPIO_NOPULL 0x0
+#define GPIO_PULLUP 0x1
+#define GPIO_PULLDOWN 0x2
+
+enum PinModifier {
+    NONE,
+    OPENDRAIN,
+    PULLUP,
+    PULLDOWN,
+    PULLNONE
+};
+
+// A GPIO with no hardware behind it, for running remora-core on the host.
+//
+// Pins are named as on the STM32 targets, "PA_0" to "PP_15". Each port is a
+// word of pin levels, outputs write it and the simulation drives the inputs
+// with Pin::drive(), so the port access the PortWriter and PortReader use works
+// as on target. Every access is counted, the benchmarks read the counters to
+// report the GPIO traffic per tick.
+class Pin
+{
+public:
+    static constexpr uint32_t portCount = 16;
+
+    struct Port {
+        uint32_t level;
+        uint32_t output;            // bit per pin, set for outputs
+        uint32_t rises[16];         // rising edges per pin
+    };
+
+    struct Counters {
+        uint64_t set;
+        uint64_t get;
+        uint64_t writePort;
+        uint64_t readPort;
+    };
+
+private:
+    static inline Port ports[portCount] = {};
+    static inline Counters counters = {};
+
+    std::string portAndPin;
+    Port* port = nullptr;           // null for a name that does not parse
+    uint32_t pinNumber = 0;
+    uint32_t pinMask = 0;
+    int dir;
+    int modifier;
+
+    static bool parse(const std::string& portAndPin, Port*& port, uint32_t& pinNumber);
+
+    static void write(Port* port, uint32_t setMask, uint32_t clearMask)
+    {
+        uint32_t risen = setMask & ~port->level;
+        port->level = (port->level | setMask) & ~clearMask;
+        while (risen) {
+            port->rises[__builtin_ctz(risen)]++;
+            risen &= risen - 1;
+        }
+    }
+
+public:
+    Pin(const std::string& portAndPin, int dir, int modifier = NONE);
+
+    void set(bool value)
+    {
+        counters.set++;
+        if (!port) return;
+        if (value) write(port, pinMask, 0);
+        else write(port, 0, pinMask);
+    }
+
+    bool get()
+    {
+        counters.get++;
+        return port && (port->level & pinMask);
+    }
+
+    void setAsOutput();
+    void setAsInput();
+    void setPullUp();
+    void setPullDown();
+    void setPullNone();
+    void setOpenDrain();
+
+    // Port access, see PortWriter and PortReader
+    void* getPort() { return port; }
+    uint32_t getPinMask() { return pinMask; }
+
+    static void writePort(void* port, uint32_t setMask, uint32_t clearMask)
+    {
+        counters.writePort++;
+        write((Port*)port, setMask, clearMask);
+    }
+
+    static uint32_t readPort(void* port)
+    {
+        counters.readPort++;
+        return ((Port*)port)->level;
+    }
+
+    // The simulation side, not part of the HAL interface
+    static bool drive(const std::string& portAndPin, bool level);   // set an input as an external signal would, false for a bad name
+    static bool level(const std::string& portAndPin);
+    static uint32_t risingEdges(const std::string& portAndPin);
+    static const Counters& getCounters() { return counters; }
+    static void resetCounters() { counters = {}; }
+    static void resetPorts();
+};
+
+#endif
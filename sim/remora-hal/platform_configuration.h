@@ -0,0 +1,52 @@
+#ifndef PLATFORM_CONFIGURATION_H
+#define PLATFORM_CONFIGURATION_H
+
+// The host platform, remora-core built as a Linux program with a simulated
+// HAL. See sim/Makefile.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// the simulated Pin has port access and there are several QEI instances
+#define HAL_PORT_IO
+#define HAL_QEI_INSTANCES
+
+typedef int IRQn_Type;
+
+inline void __NOP() {}
+
+// the simulated time does not move in the main loop, delays return at once
+inline void HAL_Delay(uint32_t) {}
+
+inline uint32_t HAL_GetTick()
+{
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline void HAL_NVIC_SystemReset()
+{
+    printf("Sim: system reset\n");
+    exit(EXIT_SUCCESS);
+}
+
+inline void pru_reboot() { HAL_NVIC_SystemReset(); }
+
+// no flash, the host build uses a static config (REMORA_STATIC_CONFIG). The
+// upload and storage regions are zeroed RAM, as the target's come from its
+// linker script, so the JSON handler finds an empty upload rather than reading
+// address 0
+inline uint8_t simJsonUpload[4096];
+inline uint8_t simJsonStorage[4096];
+
+namespace Platform_Config {
+    const std::uintptr_t JSON_upload_start_address  = reinterpret_cast<std::uintptr_t>(simJsonUpload);
+    const std::uintptr_t JSON_upload_end_address    = reinterpret_cast<std::uintptr_t>(simJsonUpload + sizeof(simJsonUpload));
+    const std::uintptr_t JSON_storage_start_address = reinterpret_cast<std::uintptr_t>(simJsonStorage);
+    const std::uintptr_t JSON_storage_end_address   = reinterpret_cast<std::uintptr_t>(simJsonStorage + sizeof(simJsonStorage));
+}
+
+#endif
@@ -0,0 +1,149 @@
+// remora-throughput, base thread ticks per second on the host.
+//
+// A 40 kHz base thread on a VirtualTimer runs N Stepgens, SoftEncoders and
+// DigitalPins against the simulated HAL for a stretch of virtual time, as fast
+// as the host allows. The ticks per wall clock second, and the ns per tick,
+// compare the core's overhead between changes on the same machine.
+//
+//      remora-throughput [stepgens] [encoders] [pins] [seconds]
+//
+// The encoders see a quadrature signal from a source module run first in each
+// tick, its cost is part of the figure.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data.h"
+#include "modules/module.h"
+#include "modules/digitalPin/digitalPin.h"
+#include "modules/softEncoder/softEncoder.h"
+#include "modules/stepgen/stepgen.h"
+#include "thread/pruThread.h"
+#include "thread/virtualTimer.h"
+#include "remora-hal/pin/pin.h"
+
+static constexpr uint32_t maxStepgens = Config::joints;
+static constexpr uint32_t maxEncoders = 8;
+static constexpr uint32_t maxPins = 16;
+
+// Steps the encoder inputs (port PD, A and B of encoder i on pins 2i and 2i+1)
+// through the quadrature sequence, one edge every ticksPerEdge ticks
+class QuadratureSource : public Module
+{
+private:
+    Pin anchor;             // any pin on PD, for the port
+    uint32_t channels;      // A and B masks of every encoder
+    uint32_t ticksPerEdge;
+    uint32_t tick = 0;
+    uint32_t phase = 0;
+
+public:
+    QuadratureSource(uint32_t encoders, uint32_t _ticksPerEdge)
+        : anchor("PD_0", INPUT),
+          channels(0),
+          ticksPerEdge(_ticksPerEdge)
+    {
+        for (uint32_t i = 0; i < encoders; i++) channels |= 3u << (2 * i);
+        bindTasks<QuadratureSource>();
+    }
+
+    void update() override
+    {
+        if (++tick < ticksPerEdge) return;
+        tick = 0;
+
+        // A leads B: 00 01 11 10
+        static const uint32_t gray[4] = { 0, 1, 3, 2 };
+        phase = (phase + 1) & 3;
+        uint32_t a = (gray[phase] & 1) ? 0x55555555 : 0;
+        uint32_t b = (gray[phase] & 2) ? 0xAAAAAAAA : 0;
+        uint32_t level = (a | b) & channels;
+        Pin::writePort(anchor.getPort(), level, channels & ~level);
+    }
+};
+
+static std::string pinName(char port, uint32_t pin)
+{
+    return std::string("P") + port + "_" + std::to_string(pin);
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t stepgens = argc > 1 ? atoi(argv[1]) : 8;
+    uint32_t encoders = argc > 2 ? atoi(argv[2]) : 4;
+    uint32_t pins = argc > 3 ? atoi(argv[3]) : 8;
+    double seconds = argc > 4 ? atof(argv[4]) : 10.0;
+
+    if (stepgens > maxStepgens || encoders > maxEncoders || pins > maxPins || seconds <= 0) {
+        printf("usage: %s [stepgens <= %lu] [encoders <= %lu] [pins <= %lu] [seconds]\n", argv[0],
+               (unsigned long)maxStepgens, (unsigned long)maxEncoders, (unsigned long)maxPins);
+        return EXIT_FAILURE;
+    }
+
+    const uint32_t baseFreq = Config::pruBaseFreq;
+    pruThread baseThread("BaseThread");
+    auto timer = std::make_unique<VirtualTimer>(baseFreq);
+    VirtualTimer* base = timer.get();
+    baseThread.setTimer(std::move(timer));
+
+    // the pin names must outlive the Stepgens, they keep the pointers
+    std::vector<std::string> names;
+    names.reserve(3 * maxStepgens);
+
+    std::vector<std::shared_ptr<Module>> modules;
+    if (encoders) modules.push_back(std::make_shared<QuadratureSource>(encoders, 4));
+
+    for (uint32_t i = 0; i < stepgens; i++) {
+        names.push_back(pinName('C', i));
+        const char* enable = names.back().c_str();
+        names.push_back(pinName('A', 2 * i));
+        const char* step = names.back().c_str();
+        names.push_back(pinName('A', 2 * i + 1));
+        const char* direction = names.back().c_str();
+
+        rxData.jointFreqCmd[i] = (int32_t)(1000 * (i + 1)) * (i & 1 ? -1 : 1);
+        auto stepgen = std::make_shared<Stepgen>(baseFreq, i, enable, step, direction, Config::ddsResolutionBits,
+                                                 rxData.jointFreqCmd[i], txData.jointFeedback[i], rxData.jointEnable, true);
+        modules.push_back(stepgen);
+    }
+    rxData.jointEnable = (jointMask_t)((1u << stepgens) - 1);
+
+    for (uint32_t i = 0; i < encoders; i++) {
+        modules.push_back(std::make_shared<SoftEncoder>(txData.processVariable[i % Config::variables],
+                                                        pinName('D', 2 * i), pinName('D', 2 * i + 1), NONE));
+    }
+
+    for (uint32_t i = 0; i < pins; i++) {
+        rxData.outputs = 0x5555;
+        modules.push_back(std::make_shared<DigitalPin>(rxData.outputs, 1, pinName('E', i), i, false, NONE));
+    }
+
+    for (const auto& module : modules) {
+        baseThread.registerModule(module);
+        if (module->getUsesModulePost()) baseThread.registerModulePost(module);
+    }
+    baseThread.startThread();
+
+    Pin::resetCounters();
+    auto start = std::chrono::steady_clock::now();
+    uint64_t ticks = VirtualTimer::run((uint64_t)(seconds * 1e9));
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const Pin::Counters& counters = Pin::getCounters();
+    printf("\n## Throughput: %lu stepgens, %lu encoders, %lu pins at %lu Hz\n",
+           (unsigned long)stepgens, (unsigned long)encoders, (unsigned long)pins, (unsigned long)baseFreq);
+    printf("%llu ticks (%llu on the timer) in %.3f s wall, %.0f ticks/s, %.1f ns/tick, %.1fx real time\n",
+           (unsigned long long)ticks, (unsigned long long)base->getTickCount(), wall, ticks / wall, wall * 1e9 / ticks, seconds / wall);
+    printf("GPIO per tick: set %.2f, get %.2f, writePort %.2f, readPort %.2f\n",
+           (double)counters.set / ticks, (double)counters.get / ticks,
+           (double)counters.writePort / ticks, (double)counters.readPort / ticks);
+    for (uint32_t i = 0; i < encoders && i < Config::variables; i++) {
+        printf("Encoder %lu count %.0f\n", (unsigned long)i, txData.processVariable[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#ifndef STATIC_CONFIG_EXAMPLE_H
+#define STATIC_CONFIG_EXAMPLE_H
+
+// Example fixed configuration, the equivalent of a small JSON config built into
+// the firmware. Build with -DREMORA_STATIC_CONFIG='"staticConfigExample.h"' (or
+// a header generated from a JSON config) to skip the JSON parsing and the module
+// factory at boot.
+//
+// The header provides two functions in namespace StaticConfig:
+//      configureThreads(Remora*)   called in place of reading the "Threads" array
+//      loadModules(Remora*)        called in place of Remora::loadModules()
+
+#include "remora.h"
+#include "modules/moduleList.h"
+#include "modules/staticPipeline.h"
+
+namespace StaticConfig {
+
+    // 3 axis stepper machine, a spindle enable output and a probe input. Each
+    // joint has its own driver enable, PA_0, PA_7 and PA_8
+    typedef StaticPipeline<Stepgen, Stepgen, Stepgen> BasePipeline;
+    typedef StaticPipeline<DigitalPin, DigitalPin> ServoPipeline;
+
+    inline BasePipeline basePipeline;
+    inline ServoPipeline servoPipeline;
+
+    inline void configureThreads(Remora* instance)
+    {
+        instance->setBaseFreq(40000);
+        instance->setServoFreq(1000);
+    }
+
+    inline void loadModules(Remora* instance)
+    {
+        uint32_t baseFreq = instance->getBaseFreq();
+        volatile rxData_t* rx = instance->getRxData();
+        volatile txData_t* tx = instance->getTxData();
+
+        basePipeline.emplace<0>(baseFreq, 0, "PA_0", "PA_1", "PA_2", Config::ddsResolutionBits, rx->jointFreqCmd[0], tx->jointFeedback[0], rx->jointEnable, true);
+        basePipeline.emplace<1>(baseFreq, 1, "PA_7", "PA_3", "PA_4", Config::ddsResolutionBits, rx->jointFreqCmd[1], tx->jointFeedback[1], rx->jointEnable, true);
+        basePipeline.emplace<2>(baseFreq, 2, "PA_8", "PA_5", "PA_6", Config::ddsResolutionBits, rx->jointFreqCmd[2], tx->jointFeedback[2], rx->jointEnable, true);
+
+        servoPipeline.emplace<0>(rx->outputs, 1, "PB_0", 0, false, NONE);
+        servoPipeline.emplace<1>(tx->inputs, 0, "PB_1", 0, false, PULLUP);
+
+        pruThread* baseThread = instance->getThread("Base");
+        baseThread->registerModule(basePipeline.shared());
+        if (basePipeline.getUsesModulePost()) {
+            baseThread->registerModulePost(basePipeline.shared());
+        }
+
+        pruThread* servoThread = instance->getThread("Servo");
+        servoThread->registerModule(servoPipeline.shared());
+        if (servoPipeline.getUsesModulePost()) {
+            servoThread->registerModulePost(servoPipeline.shared());
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef CYCLECOUNTER_H
+#define CYCLECOUNTER_H
+
+#include <cstdint>
+
+// Free running cycle counter used to time the thread ISRs.
+// Implemented by the HAL, for example with the DWT CYCCNT register on Cortex-M
+// or a spare free running timer on parts without one.
+
+class CycleCounter {
+public:
+    virtual ~CycleCounter() = default;
+
+    virtual void init() = 0;
+    virtual uint32_t getCycles() const = 0;     // current count, wraps at 2^32
+    virtual uint32_t getFrequency() const = 0;  // counts per second
+};
+
+#endif // CYCLECOUNTER_H
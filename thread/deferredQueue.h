@@ -0,0 +1,75 @@
+#ifndef DEFERREDQUEUE_H
+#define DEFERREDQUEUE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+constexpr size_t deferredQueueSize = 16;        // work items per thread
+
+// Work posted from a thread ISR to be run later by the main loop, for anything
+// that must not run at interrupt priority (printf, blocking peripheral access,
+// slow maths). The function is called with the context and arguments it was
+// posted with.
+typedef void (*DeferredFunction)(void* context, int32_t arg, float value);
+
+struct DeferredWork {
+    DeferredFunction function;
+    void* context;
+    int32_t arg;
+    float value;
+};
+
+// Fixed capacity single producer / single consumer ring buffer.
+// The producer is the owning thread's ISR, the consumer is the main loop.
+// Size must be a power of two.
+template <size_t Size>
+class DeferredQueue {
+    static_assert(Size && ((Size & (Size - 1)) == 0), "DeferredQueue size must be a power of two");
+
+private:
+    DeferredWork items[Size];
+    std::atomic<uint32_t> head{0};      // written by the producer
+    std::atomic<uint32_t> tail{0};      // written by the consumer
+    std::atomic<uint32_t> dropped{0};
+
+public:
+    bool post(const DeferredWork& work)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Size) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (Size - 1)] = work;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(DeferredWork& work)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        work = items[t & (Size - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // run everything queued so far, returns the number of items run
+    uint32_t run()
+    {
+        uint32_t count = 0;
+        DeferredWork work;
+        while (pop(work)) {
+            work.function(work.context, work.arg, work.value);
+            count++;
+        }
+        return count;
+    }
+
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+typedef DeferredQueue<deferredQueueSize> ThreadWorkQueue;
+
+#endif // DEFERREDQUEUE_H
@@ -0,0 +1,94 @@
+#ifndef PORTREADER_H
+#define PORTREADER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "portWriter.h"
+#include "../../remora-hal/pin/pin.h"
+
+// Input ports sampled once at the start of a thread tick. The modules read
+// their pins from the snapshot, so several inputs on a port cost one GPIO read
+// and all the modules see the inputs as they were at the same instant.
+//
+// Opt in with HAL_PORT_IO, as for the PortWriter. The HAL Pin must also provide
+// a combined port read:
+//      static uint32_t Pin::readPort(void* port)
+// Without it bind() always fails and the modules read their pins with get().
+#ifdef HAL_PORT_IO
+class PortReader
+{
+public:
+    static constexpr uint8_t maxPorts = 8;
+
+private:
+    void* volatile ports[maxPorts] = {};    // nullptr for a free slot
+    uint32_t values[maxPorts] = {};
+    uint8_t users[maxPorts] = {};           // bound pins per port
+    uint8_t portCount = 0;                  // slots in use or freed
+
+public:
+    // Find or add the pin's port, called from the main loop. Returns false when
+    // there is no room, the caller should then read the pin directly.
+    bool bind(Pin& pin, PortBit& bit)
+    {
+        void* port = pin.getPort();
+        if (!port) return false;
+
+        uint8_t i = 0;
+        while (i < portCount && ports[i] != port) i++;
+
+        if (i == portCount) {
+            // reuse a slot freed by unbind() before adding one
+            uint8_t free = 0;
+            while (free < portCount && ports[free] != nullptr) free++;
+            if (free == maxPorts) return false;
+
+            i = free;
+            values[i] = Pin::readPort(port);
+            std::atomic_signal_fence(std::memory_order_release);   // value ready before the ISR can see the slot
+            ports[i] = port;
+            if (i == portCount) portCount++;
+        }
+
+        users[i]++;
+        bit.port = i;
+        bit.mask = pin.getPinMask();
+        return true;
+    }
+
+    // Release a pin bound by bind(), the port is no longer sampled once its
+    // last pin is released
+    void unbind(const PortBit& bit)
+    {
+        if (bit.port >= portCount || users[bit.port] == 0) return;
+        if (--users[bit.port] == 0) ports[bit.port] = nullptr;
+    }
+
+    void sample()
+    {
+        for (uint8_t i = 0; i < portCount; i++) {
+            void* port = ports[i];
+            if (port) values[i] = Pin::readPort(port);
+        }
+    }
+
+    bool get(const PortBit& bit) const { return (values[bit.port] & bit.mask) != 0; }
+};
+
+#else
+
+class PortReader
+{
+public:
+    static constexpr uint8_t maxPorts = 0;
+
+    bool bind(Pin&, PortBit&) { return false; }
+    void unbind(const PortBit&) {}
+    void sample() {}
+    bool get(const PortBit&) const { return false; }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef PORTWRITER_H
+#define PORTWRITER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "../configuration.h"         // the platform configuration, which may define HAL_PORT_IO
+#include "../../remora-hal/pin/pin.h"
+
+// A pin's position in a PortWriter
+struct PortBit {
+    uint8_t port;
+    uint32_t mask;
+};
+
+// Output changes staged by the modules during a thread tick, then written as
+// one set/reset access per GPIO port. This cuts the number of GPIO writes and
+// makes the edges on a port simultaneous.
+//
+// Opt in, a HAL that provides the port access below defines HAL_PORT_IO (in
+// its platform_configuration.h or as a build flag):
+//      void* Pin::getPort()
+//      uint32_t Pin::getPinMask()
+//      static void Pin::writePort(void* port, uint32_t setMask, uint32_t clearMask)
+// Without it bind() always fails and the modules write their pins with set().
+//
+// The thread flushes after the update tasks and again after the post tasks, so
+// a pulse set in update() and cleared in updatePost() is only as wide as the
+// post tasks take to run. Config::minPortPulseNs holds the second flush back to
+// a minimum width, that needs a cycle counter. Outputs that need a defined
+// pulse width should otherwise use a timer pulse output (Stepgen "Sub Tick Steps").
+#ifdef HAL_PORT_IO
+class PortWriter
+{
+public:
+    static constexpr uint8_t maxPorts = 8;
+
+private:
+    struct PortMasks {
+        void* port;
+        uint32_t set;
+        uint32_t clear;
+    };
+
+    PortMasks ports[maxPorts];
+    uint8_t portCount = 0;
+
+public:
+    // Find or add the pin's port, called from the main loop. Returns false when
+    // there is no room, the caller should then write the pin directly.
+    bool bind(Pin& pin, PortBit& bit)
+    {
+        void* port = pin.getPort();
+        uint8_t i = 0;
+        while (i < portCount && ports[i].port != port) i++;
+
+        if (i == portCount) {
+            if (portCount == maxPorts) return false;
+            ports[i] = { port, 0, 0 };
+            std::atomic_signal_fence(std::memory_order_release);   // entry complete before the ISR can see it
+            portCount++;
+        }
+
+        bit.port = i;
+        bit.mask = pin.getPinMask();
+        return true;
+    }
+
+    void stage(const PortBit& bit, bool value)
+    {
+        PortMasks& p = ports[bit.port];
+        if (value) {
+            p.set |= bit.mask;
+            p.clear &= ~bit.mask;
+        } else {
+            p.clear |= bit.mask;
+            p.set &= ~bit.mask;
+        }
+    }
+
+    void flush()
+    {
+        for (uint8_t i = 0; i < portCount; i++) {
+            PortMasks& p = ports[i];
+            if (p.set | p.clear) {
+                Pin::writePort(p.port, p.set, p.clear);
+                p.set = 0;
+                p.clear = 0;
+            }
+        }
+    }
+};
+
+#else
+
+class PortWriter
+{
+public:
+    static constexpr uint8_t maxPorts = 0;
+
+    bool bind(Pin&, PortBit&) { return false; }
+    void stage(const PortBit&, bool) {}
+    void flush() {}
+};
+
+#endif
+
+#endif
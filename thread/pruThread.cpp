@@ -1,7 +1,8 @@
 #include <cstdio>
 #include <algorithm>
+#include <numeric>
 #include "pruThread.h"
-#include "../modules/module.h"
+#include "../configuration.h"
 
 pruThread::pruThread(const std::string& _name)
     : threadName(_name)
@@ -13,31 +14,221 @@ void pruThread::setTimer(std::unique_ptr<pruTimer> _timer)
     timerPtr->setOwner(this);
 }
 
+// Run one task, timing it when module profiling is built in
+inline void pruThread::runTask(const ModuleTask& task, [[maybe_unused]] TaskKind kind)
+{
+#ifdef MODULE_PROFILING
+    if (cycleCounter) {
+        uint32_t start = cycleCounter->getCycles();
+        task.function(task.module);
+        uint32_t cycles = cycleCounter->getCycles() - start;
+
+        TaskTiming& timing = task.module->getTiming(kind);
+        if (cycles > timing.max) timing.max = cycles;
+        timing.sum += cycles;
+        timing.count++;
+        return;
+    }
+#endif
+    task.function(task.module);
+}
+
 bool pruThread::executeModules()
 {
-    for (const auto& module : modules) if (module) module->runModule();
-    if (hasModulesPost) for (const auto& module : modulesPost) if (module) module->runModulePost();
+    TaskTable& table = taskTable[activeTaskTable.load(std::memory_order_acquire)];
+    bool shedding = shedCountdown > 0;
+
+    // after loading the table, a module in it has its ports in the reader
+    portReader.sample();
+
+    for (RateGroup& group : table.rateGroups) {
+        if (++group.tick >= group.divisor) {
+            group.tick = 0;
+            group.next = group.first;
+        }
+        uint32_t end = group.first + group.count;
+        while (group.next < end && table.slowTasks[group.next].phase == group.tick) {
+            const SlowTask& slowTask = table.slowTasks[group.next++];
+            if (shedding && slowTask.sheddable) continue;
+            runTask(slowTask.task, TASK_SLOW_UPDATE);
+        }
+    }
+
+    for (const ModuleTask& task : table.tasks) runTask(task, TASK_UPDATE);
+    if (!shedding) for (const ModuleTask& task : table.sheddableTasks) runTask(task, TASK_UPDATE);
+    portWriter.flush();
+#ifdef HAL_PORT_IO
+    uint32_t pulseStart = minPulseCycles ? cycleCounter->getCycles() : 0;
+#endif
+
+    for (const ModuleTask& task : table.postTasks) runTask(task, TASK_UPDATE_POST);
+
+#ifdef HAL_PORT_IO
+    // hold the pulses set in the update flush to the minimum width
+    if (minPulseCycles) {
+        while (cycleCounter->getCycles() - pulseStart < minPulseCycles) {}
+    }
+#endif
+    portWriter.flush();
     return true;
 }
 
+// Flatten the registered modules into contiguous task tables: normal priority
+// update work, low priority update work and then the post work, each in
+// registration order, with the slow work split out into rate groups. Modules
+// with nothing to do are left out. The table is built in the inactive buffer
+// and then published, the ISR cannot be part way through the old table once
+// the main loop resumes.
+void pruThread::compileTasks()
+{
+    uint8_t next = activeTaskTable.load(std::memory_order_relaxed) ^ 1;
+    TaskTable& table = taskTable[next];
+
+    table.tasks.clear();
+    table.sheddableTasks.clear();
+    table.postTasks.clear();
+    table.tasks.reserve(modules.size());
+    table.postTasks.reserve(modulesPost.size());
+
+    for (const auto& module : modules) {
+        if (!module->getUsesModuleUpdate()) continue;
+        if (module->getPriority() == PRIORITY_LOW) {
+            table.sheddableTasks.push_back(module->getUpdateTask());
+        } else {
+            table.tasks.push_back(module->getUpdateTask());
+        }
+    }
+    for (const auto& module : modulesPost) {
+        table.postTasks.push_back(module->getUpdatePostTask());
+    }
+
+    compileRateGroups(table);
+
+    activeTaskTable.store(next, std::memory_order_release);
+}
+
+// Group the slow modules by slow update frequency and give each one a phase
+// within its group's period. Two tasks with divisors d1, d2 and phases p1, p2
+// land on the same tick at some point iff p1 == p2 (mod gcd(d1, d2)), so each
+// task takes the phase that collides with the fewest tasks already placed,
+// searching from an evenly spaced starting point within its group.
+void pruThread::compileRateGroups(TaskTable& table)
+{
+    table.slowTasks.clear();
+    table.rateGroups.clear();
+
+    std::vector<Module*> slowModules;
+    for (const auto& module : modules) {
+        if (module->getUsesSlowUpdate() && module->getSlowUpdateFreq() > 0) slowModules.push_back(module.get());
+    }
+    if (slowModules.empty()) return;
+
+    // fastest groups first, they have the fewest phases to choose from
+    std::stable_sort(slowModules.begin(), slowModules.end(), [](Module* a, Module* b) {
+        return a->getSlowUpdateFreq() > b->getSlowUpdateFreq();
+    });
+
+    uint32_t freq = getFrequency();
+    std::vector<uint32_t> placedDivisors;
+    table.slowTasks.reserve(slowModules.size());
+
+    for (size_t i = 0; i < slowModules.size(); ) {
+        uint32_t slowFreq = slowModules[i]->getSlowUpdateFreq();
+        size_t end = i;
+        while (end < slowModules.size() && (uint32_t)slowModules[end]->getSlowUpdateFreq() == slowFreq) end++;
+
+        RateGroup group;
+        group.slowUpdateFreq = slowFreq;
+        group.divisor = std::max<uint32_t>(1, freq / slowFreq);
+        group.tick = group.divisor - 1;
+        group.first = table.slowTasks.size();
+        group.count = end - i;
+        group.next = group.first + group.count;
+
+        // two tasks collide on the ticks where their phases agree modulo the gcd
+        // of their divisors, worked out once per group for the tasks placed so far
+        std::vector<uint32_t> placedGcd(table.slowTasks.size());
+        std::vector<uint32_t> placedResidue(table.slowTasks.size());
+        for (size_t j = 0; j < table.slowTasks.size(); j++) {
+            placedGcd[j] = std::gcd(group.divisor, placedDivisors[j]);
+            placedResidue[j] = table.slowTasks[j].phase % placedGcd[j];
+        }
+
+        for (size_t n = 0; n < group.count; n++) {
+            uint32_t phase = group.divisor - 1;     // unstaggered, as the old per module counter
+
+            if (staggerSlowUpdates) {
+                uint32_t start = (uint32_t)(((uint64_t)n * group.divisor) / group.count);
+                uint32_t bestCollisions = UINT32_MAX;
+
+                // the even spread start is usually free, a few phases past it are
+                // tried rather than the whole period, a slow group can be thousands of ticks
+                uint32_t search = std::min(group.divisor, Config::staggerSearchPhases);
+                for (uint32_t k = 0; k < search && bestCollisions > 0; k++) {
+                    uint32_t candidate = (start + k) % group.divisor;
+                    uint32_t collisions = 0;
+                    for (size_t j = 0; j < placedGcd.size(); j++) {
+                        if (candidate % placedGcd[j] == placedResidue[j]) collisions++;
+                    }
+                    if (collisions < bestCollisions) {
+                        bestCollisions = collisions;
+                        phase = candidate;
+                    }
+                }
+            }
+
+            Module* module = slowModules[i + n];
+            table.slowTasks.push_back({ module->getSlowUpdateTask(), phase, module->getPriority() == PRIORITY_LOW });
+            placedDivisors.push_back(group.divisor);
+            placedGcd.push_back(group.divisor);
+            placedResidue.push_back(phase);
+        }
+
+        std::sort(table.slowTasks.begin() + group.first, table.slowTasks.end(), [](const SlowTask& a, const SlowTask& b) {
+            return a.phase < b.phase;
+        });
+        table.rateGroups.push_back(group);
+        i = end;
+    }
+}
+
 bool pruThread::registerModule(std::shared_ptr<Module> module)
 {
     if (!module) return false;
+
+    // reported here rather than in the Module constructor, static modules are
+    // constructed before stdio is up
+    if (module->getUsesSlowUpdate() && module->getSlowUpdateFreq() > 0) {
+        printf("\nAdding a slower module to %s, updating every %lu thread cycles\n", threadName.c_str(), (unsigned long)(getFrequency() / module->getSlowUpdateFreq()));
+    } else {
+        printf("\nAdding a std module to %s\n", threadName.c_str());
+    }
+
+    module->setWorkQueue(&workQueue);
+    module->setPortWriter(&portWriter);
+    module->setPortReader(&portReader);
     modules.push_back(module);
+    if (isRunning()) compileTasks();
     return true;
 }
 
 bool pruThread::registerModulePost(std::shared_ptr<Module> module)
 {
     if (!module) return false;
-    hasModulesPost = true;
+    module->setWorkQueue(&workQueue);
+    module->setPortWriter(&portWriter);
+    module->setPortReader(&portReader);
     modulesPost.push_back(module);
+    if (isRunning()) compileTasks();
     return true;
 }
 
 bool pruThread::unregisterModule(std::shared_ptr<Module> module)
 {
     if (!module) return false;
+    module->setWorkQueue(nullptr);
+    module->setPortWriter(nullptr);
+    module->setPortReader(nullptr);
 
     auto iter = std::remove_if(modules.begin(), modules.end(),
         [&module](const std::shared_ptr<Module>& mod) {
@@ -51,7 +242,7 @@ bool pruThread::unregisterModule(std::shared_ptr<Module> module)
         });
     modulesPost.erase(postIter, modulesPost.end());
 
-    hasModulesPost = !modulesPost.empty();
+    if (isRunning()) compileTasks();
 
     return true;
 }
@@ -59,6 +250,10 @@ bool pruThread::unregisterModule(std::shared_ptr<Module> module)
 bool pruThread::startThread()
 {
     if (isRunning()) return true;
+    compileTasks();
+    if (cycleCounter && timerPtr->getFrequency()) {
+        configureStats(timerPtr->getFrequency());
+    }
     setThreadRunning(true);
     setThreadPaused(false);
 	timerPtr->configTimer();
@@ -76,10 +271,162 @@ void pruThread::stopThread()
 bool pruThread::update()
 {
     if (!isRunning() || isPaused()) return true;
-    return executeModules();
+
+    uint32_t freq = pendingFrequency.load(std::memory_order_acquire);
+    if (freq) applyFrequency(freq);
+
+    uint32_t servoFreq = pendingServoFrequency.load(std::memory_order_acquire);
+    if (servoFreq) {
+        for (const auto& module : modules) module->changeServoFreq(servoFreq);
+        pendingServoFrequency.store(0, std::memory_order_release);
+    }
+
+    tickCount.store(tickCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);   // only the ISR writes
+
+    if (!cycleCounter) {
+        // without a cycle counter the tick is timed in ticks of a faster thread,
+        // and the timer's pending flag shows a tick that ran into the next period
+        uint32_t ratio = timebase ? timebase->getFrequency() / getFrequency() : 0;
+        uint32_t entry = timebase ? timebase->getTickCount() : 0;
+        bool result = executeModules();
+        uint32_t elapsed = ratio >= 2 ? timebase->getTickCount() - entry : 0;
+
+        bool overrun = timerPtr->isTickPending() || (ratio >= 2 && elapsed >= ratio);
+        if (overrun) untimedOverruns++;
+        updateShedding(overrun || (ratio >= 2 && elapsed * 100 >= ratio * Config::overloadPercent));
+        return result;
+    }
+
+    uint32_t entry = cycleCounter->getCycles();
+    bool result = executeModules();
+    uint32_t exit = cycleCounter->getCycles();
+
+    stats.record(entry, exit);
+    updateShedding(exit - entry > overloadLimit);
+
+    return result;
+}
+
+// Shed low priority work for a while once a tick gets close to the period
+void pruThread::updateShedding(bool overloaded)
+{
+    if (overloaded) {
+        shedCountdown = Config::loadShedTicks;
+    } else if (shedCountdown) {
+        shedCountdown--;
+    }
+}
+
+void pruThread::configureStats(uint32_t freq)
+{
+    uint32_t period = cycleCounter->getFrequency() / freq;
+    stats.configure(period);
+    overloadLimit = (uint32_t)(((uint64_t)period * Config::overloadPercent) / 100);
+    minPulseCycles = (uint32_t)(((uint64_t)cycleCounter->getFrequency() * Config::minPortPulseNs) / 1000000000ULL);
+    shedCountdown = 0;
+}
+
+// Change the thread frequency. Before the thread starts this simply sets the timer
+// frequency. While running the change is handed to the ISR, which rescales every
+// module and retimes the timer at a tick boundary so no tick runs half rescaled.
+bool pruThread::setFrequency(uint32_t freq)
+{
+    if (!timerPtr || freq == 0) return false;
+
+    if (!isRunning()) {
+        timerPtr->setFrequency(freq);
+        for (const auto& module : modules) module->changeThreadFreq(freq);
+        return true;
+    }
+
+    pendingFrequency.store(freq, std::memory_order_release);
+    return true;
+}
+
+// Tell the modules the servo thread frequency changed, eg to ramp commands over
+// the servo period. While running this is applied by the ISR at a tick boundary.
+void pruThread::setServoFrequency(uint32_t freq)
+{
+    if (freq == 0) return;
+
+    if (!isRunning()) {
+        for (const auto& module : modules) module->changeServoFreq(freq);
+        return;
+    }
+
+    pendingServoFrequency.store(freq, std::memory_order_release);
+}
+
+// Called from the ISR
+void pruThread::applyFrequency(uint32_t freq)
+{
+    for (const auto& module : modules) module->changeThreadFreq(freq);
+
+    // rescale the rate groups in place, keeping each task's relative phase
+    TaskTable& table = taskTable[activeTaskTable.load(std::memory_order_acquire)];
+    for (RateGroup& group : table.rateGroups) {
+        uint32_t divisor = std::max<uint32_t>(1, freq / group.slowUpdateFreq);
+        for (uint32_t i = group.first; i < group.first + group.count; i++) {
+            table.slowTasks[i].phase = (uint32_t)(((uint64_t)table.slowTasks[i].phase * divisor) / group.divisor);
+        }
+        group.divisor = divisor;
+        group.tick = divisor - 1;
+        group.next = group.first + group.count;
+    }
+    timerPtr->changeFrequency(freq);
+
+    if (cycleCounter) {
+        configureStats(freq);
+    }
+
+    pendingFrequency.store(0, std::memory_order_release);
 }
 
 void pruThread::pauseThread() { setThreadPaused(true); }
 void pruThread::resumeThread() { setThreadPaused(false); }
 const std::string& pruThread::getName() const { return threadName; }
 uint32_t pruThread::getFrequency() const { return timerPtr ? timerPtr->getFrequency() : 0; }
+
+#ifdef MODULE_PROFILING
+// Print the modules ranked by average cycles per thread tick. The counters are
+// read while the ISR may be updating them, good enough for a diagnostic report.
+void pruThread::printModuleReport(size_t topN) const
+{
+    if (!cycleCounter) return;
+
+    uint32_t ticks = stats.getTicks();
+    if (ticks == 0) return;
+
+    struct Entry { Module* module; uint64_t total; };
+    std::vector<Entry> entries;
+    for (const auto& module : modules) {
+        uint64_t total = 0;
+        for (int kind = 0; kind < TASK_KINDS; kind++) total += module->getTiming((TaskKind)kind).sum;
+        entries.push_back({ module.get(), total });
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.total > b.total; });
+
+    uint32_t counterFreq = cycleCounter->getFrequency();
+    auto ns = [counterFreq](uint64_t cycles) -> uint32_t {
+        return (uint32_t)((cycles * 1000000000ULL) / counterFreq);
+    };
+    auto avg = [](const TaskTiming& t) -> uint64_t { return t.count ? t.sum / t.count : 0; };
+
+    printf("\n%s module timing (ns), ranked by average cost per tick\n", threadName.c_str());
+    printf("  #  per tick  update avg/max    post avg/max    slow avg/max    type, comment\n");
+
+    for (size_t i = 0; i < entries.size() && i < topN; i++) {
+        Module* module = entries[i].module;
+        const TaskTiming& update = module->getTiming(TASK_UPDATE);
+        const TaskTiming& post = module->getTiming(TASK_UPDATE_POST);
+        const TaskTiming& slow = module->getTiming(TASK_SLOW_UPDATE);
+
+        printf("%3u %9lu %7lu/%-7lu %7lu/%-7lu %7lu/%-7lu  %s, %s\n", (unsigned)(i + 1),
+               ns(entries[i].total / ticks),
+               ns(avg(update)), ns(update.max),
+               ns(avg(post)), ns(post.max),
+               ns(avg(slow)), ns(slow.max),
+               module->getModuleType().c_str(), module->getComment().c_str());
+    }
+}
+#endif
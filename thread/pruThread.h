@@ -7,8 +7,40 @@
 #include <atomic>
 
 #include "pruTimer.h"
+#include "cycleCounter.h"
+#include "threadStats.h"
+#include "deferredQueue.h"
+#include "portWriter.h"
+#include "portReader.h"
+#include "../modules/module.h"
 
-class Module;
+
+// A slow update task, run once per rate group period on its assigned phase
+struct SlowTask {
+    ModuleTask task;
+    uint32_t phase;
+    bool sheddable;
+};
+
+// Slow tasks sharing a slow update frequency. The group counts thread ticks
+// through its period and runs the tasks whose phase matches, the tasks are
+// stored contiguously and sorted by phase.
+struct RateGroup {
+    uint32_t slowUpdateFreq;
+    uint32_t divisor;           // thread ticks per period
+    uint32_t tick;              // position within the period
+    uint32_t first;             // first task in the slow task table
+    uint32_t count;
+    uint32_t next;              // next task to run this period
+};
+
+struct TaskTable {
+    std::vector<ModuleTask> tasks;              // normal priority update work
+    std::vector<ModuleTask> sheddableTasks;     // low priority update work, skipped under overload
+    std::vector<ModuleTask> postTasks;
+    std::vector<SlowTask> slowTasks;
+    std::vector<RateGroup> rateGroups;
+};
 
 
 class pruThread
@@ -20,15 +52,61 @@ private:
     std::atomic<bool> threadPaused{false};
     std::vector<std::shared_ptr<Module>> modules;
     std::vector<std::shared_ptr<Module>> modulesPost;
-    bool hasModulesPost{false};
+
+    // Flattened task table executed by the ISR, double buffered so it can be
+    // recompiled from the main loop while the thread is running
+    TaskTable taskTable[2];
+    std::atomic<uint8_t> activeTaskTable{0};
+
+    // ISR timing, only collected when a cycle counter has been set
+    CycleCounter* cycleCounter{nullptr};
+    ThreadStats stats;
+    uint32_t minPulseCycles{0};     // Config::minPortPulseNs in cycle counter counts
+
+    // spread the slowUpdate() tasks over the ticks, see compileRateGroups()
+    bool staggerSlowUpdates{Config::staggerSlowUpdates};
+
+    // overload handling, low priority work is shed while the countdown runs
+    uint32_t overloadLimit{0};
+    uint32_t shedCountdown{0};
+
+    // overruns seen without a cycle counter, from the timer's pending flag or
+    // from the ticks of a faster timebase thread
+    const pruThread* timebase{nullptr};
+    uint32_t untimedOverruns{0};
+
+    // work posted by the modules for the main loop
+    ThreadWorkQueue workQueue;
+
+    // GPIO writes staged by the modules, flushed after the update and post tasks
+    PortWriter portWriter;
+
+    // GPIO inputs bound by the modules, sampled before the tasks run
+    PortReader portReader;
+
+    // ticks run, a timebase for the modules
+    std::atomic<uint32_t> tickCount{0};
+
+    // frequency change requested by the main loop, applied by the ISR
+    std::atomic<uint32_t> pendingFrequency{0};
+    std::atomic<uint32_t> pendingServoFrequency{0};
 
     void setThreadRunning(bool val) { threadRunning.store(val, std::memory_order_release); }
     void setThreadPaused(bool val) { threadPaused.store(val, std::memory_order_release); }
     bool executeModules();
+    inline void runTask(const ModuleTask& task, TaskKind kind);
+    void compileTasks();
+    void compileRateGroups(TaskTable& table);
+    void applyFrequency(uint32_t freq);
+    void configureStats(uint32_t freq);
+    void updateShedding(bool overloaded);
 
 public:
     pruThread(const std::string& _name);
     void setTimer(std::unique_ptr<pruTimer> _timer);
+    void setCycleCounter(CycleCounter* _counter) { cycleCounter = _counter; }
+    void setTimebase(const pruThread* _timebase) { timebase = _timebase; }     // a faster thread, times the ticks without a cycle counter
+    void setStaggerSlowUpdates(bool stagger) { staggerSlowUpdates = stagger; }   // before startThread(), Config::staggerSlowUpdates by default
     bool registerModule(std::shared_ptr<Module> module);
     bool registerModulePost(std::shared_ptr<Module> module);
     bool unregisterModule(std::shared_ptr<Module> module);
@@ -41,6 +119,21 @@ public:
     void resumeThread();
     const std::string& getName() const;
     uint32_t getFrequency() const;
+    bool setFrequency(uint32_t freq);
+    void setServoFrequency(uint32_t freq);      // pass a servo thread retime to the modules
+    bool isFrequencyChangePending() const { return pendingFrequency.load(std::memory_order_acquire) != 0; }
+    bool hasStats() const { return cycleCounter != nullptr; }
+    uint32_t getTicks() const { return stats.getTicks(); }
+    uint32_t getTickCount() const { return tickCount.load(std::memory_order_relaxed); }
+    uint32_t getTotalOverruns() const { return stats.getTotalOverruns() + untimedOverruns; }
+    bool isShedding() const { return shedCountdown > 0; }
+    void getStats(ThreadStatsData& snapshot) const { stats.getSnapshot(snapshot); }
+    void resetStats() { stats.requestReset(); }
+    uint32_t runDeferredWork() { return workQueue.run(); }
+    uint32_t getDeferredDropped() const { return workQueue.getDropped(); }
+#ifdef MODULE_PROFILING
+    void printModuleReport(size_t topN) const;
+#endif
 };
 
 #endif
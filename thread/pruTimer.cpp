@@ -1,6 +1,7 @@
 #include "pruTimer.h"
 #include "timerInterrupt.h"
 
+pruTimer::pruTimer() = default;
 pruTimer::~pruTimer() = default;
 
 void pruTimer::setOwner(pruThread* owner) {
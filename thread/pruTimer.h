@@ -15,12 +15,25 @@ protected:
     bool timerRunning = false;
 
 public:
+    pruTimer();             // out of line with the destructor, so timers need not see TimerInterrupt
     virtual ~pruTimer();
 
     void setOwner(pruThread* owner);
     void setFrequency(uint32_t freq);
     uint32_t getFrequency() const;
 
+    // Change the period of a running timer. This is called from the timer's own
+    // tick, HAL implementations write the new period to the preload/shadow
+    // register (eg ARR with ARPE set on an STM32) so it takes effect at the next
+    // update event without losing or repeating a tick. There is no default,
+    // stopping and restarting the timer from its own ISR loses the phase.
+    virtual void changeFrequency(uint32_t freq) = 0;
+
+    // True when the timer's next update event is already pending, ie the tick
+    // being run has overrun its period. HAL implementations should return the
+    // timer's update interrupt flag, the default cannot tell.
+    virtual bool isTickPending() const { return false; }
+
     virtual void configTimer() = 0;
     virtual void startTimer() = 0;
     virtual void stopTimer() = 0;
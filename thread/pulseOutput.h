@@ -0,0 +1,20 @@
+#ifndef PULSEOUTPUT_H
+#define PULSEOUTPUT_H
+
+#include <cstdint>
+
+// Timer driven pulse output, a compare or one-pulse channel driving a pin.
+// Implemented by the HAL. A pulse is scheduled from the thread ISR with a delay
+// measured from the start of the current thread tick, so the edge timing comes
+// from the timer clock rather than the thread rate. Stepgen schedules its steps
+// in the following tick period, the delay can be up to two thread periods.
+
+class PulseOutput {
+public:
+    virtual ~PulseOutput() = default;
+
+    virtual uint32_t getClockFrequency() const = 0;                 // timer counts per second
+    virtual void schedulePulse(uint32_t delay, uint32_t width) = 0; // in timer counts, delay from the current tick
+};
+
+#endif // PULSEOUTPUT_H
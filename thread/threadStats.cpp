@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <cstring>
+#include "threadStats.h"
+
+ThreadStats::ThreadStats()
+{
+    data.ticks = 0;
+    data.totalOverruns = 0;
+    data.nominalPeriod = 0;
+    data.bucketWidth = 1;
+    clear();
+}
+
+void ThreadStats::clear()
+{
+    data.durationSamples = 0;
+    data.periodSamples = 0;
+    data.periodMin = UINT32_MAX;
+    data.periodMax = 0;
+    data.periodSum = 0;
+    data.durationMin = UINT32_MAX;
+    data.durationMax = 0;
+    data.durationSum = 0;
+    memset(data.periodHistogram, 0, sizeof(data.periodHistogram));
+    memset(data.durationHistogram, 0, sizeof(data.durationHistogram));
+    data.overruns = 0;
+    data.lateTicks = 0;
+    data.missedTicks = 0;
+    data.worstOverrun = 0;
+    data.worstOverrunTick = 0;
+    hasLastEntry = false;
+}
+
+void ThreadStats::configure(uint32_t nominalPeriod)
+{
+    data.nominalPeriod = nominalPeriod;
+    data.bucketWidth = (nominalPeriod / 8) ? (nominalPeriod / 8) : 1;
+    clear();
+}
+
+bool ThreadStats::record(uint32_t entry, uint32_t exit)
+{
+    sequence.fetch_add(1, std::memory_order_acq_rel);
+
+    if (resetPending.exchange(false, std::memory_order_acq_rel)) {
+        clear();
+    }
+
+    uint32_t duration = exit - entry;
+    uint32_t bucket = duration / data.bucketWidth;
+    data.durationHistogram[bucket < threadStatsBuckets ? bucket : threadStatsBuckets - 1]++;
+    if (duration < data.durationMin) data.durationMin = duration;
+    if (duration > data.durationMax) data.durationMax = duration;
+    data.durationSum += duration;
+    data.durationSamples++;
+
+    bool overrun = data.nominalPeriod && duration > data.nominalPeriod;
+    if (overrun) {
+        data.overruns++;
+        data.totalOverruns++;
+        if (duration > data.worstOverrun) {
+            data.worstOverrun = duration;
+            data.worstOverrunTick = data.ticks;
+        }
+    }
+
+    if (hasLastEntry) {
+        uint32_t period = entry - lastEntry;
+        bucket = period / data.bucketWidth;
+        data.periodHistogram[bucket < threadStatsBuckets ? bucket : threadStatsBuckets - 1]++;
+        if (period < data.periodMin) data.periodMin = period;
+        if (period > data.periodMax) data.periodMax = period;
+        data.periodSum += period;
+        data.periodSamples++;
+
+        // more than half a period late, count any whole periods skipped as missed
+        if (data.nominalPeriod && period > data.nominalPeriod + data.nominalPeriod / 2) {
+            data.lateTicks++;
+            data.missedTicks += (period + data.nominalPeriod / 2) / data.nominalPeriod - 1;
+        }
+    }
+
+    lastEntry = entry;
+    hasLastEntry = true;
+    data.ticks++;
+
+    sequence.fetch_add(1, std::memory_order_acq_rel);
+
+    return overrun;
+}
+
+void ThreadStats::getSnapshot(ThreadStatsData& snapshot) const
+{
+    uint32_t start, end;
+    do {
+        start = sequence.load(std::memory_order_acquire);
+        memcpy(&snapshot, &data, sizeof(snapshot));
+        end = sequence.load(std::memory_order_acquire);
+    } while ((start & 1) || start != end);
+}
+
+void ThreadStats::print(const char* name, const ThreadStatsData& s, uint32_t counterFreq)
+{
+    // cycle counts to nanoseconds
+    auto ns = [counterFreq](uint64_t cycles) -> unsigned long {
+        return counterFreq ? (unsigned long)(uint32_t)((cycles * 1000000000ULL) / counterFreq) : 0;
+    };
+
+    printf("\n%s timing, %lu samples, nominal period %lu ns\n", name, (unsigned long)s.durationSamples, ns(s.nominalPeriod));
+
+    if (s.durationSamples == 0) return;
+
+    uint32_t periodMean = s.periodSamples ? (uint32_t)(s.periodSum / s.periodSamples) : 0;
+    uint32_t durationMean = (uint32_t)(s.durationSum / s.durationSamples);
+
+    if (s.periodSamples) {
+        printf("  period   min %lu  max %lu  mean %lu ns\n", ns(s.periodMin), ns(s.periodMax), ns(periodMean));
+    }
+    printf("  duration min %lu  max %lu  mean %lu ns\n", ns(s.durationMin), ns(s.durationMax), ns(durationMean));
+    printf("  overruns %lu  late %lu  missed %lu", (unsigned long)s.overruns, (unsigned long)s.lateTicks, (unsigned long)s.missedTicks);
+    if (s.overruns) {
+        printf("  worst %lu ns at tick %lu", ns(s.worstOverrun), (unsigned long)s.worstOverrunTick);
+    }
+    printf("\n");
+
+    printf("  bucket (ns)      period   duration\n");
+    for (uint32_t i = 0; i < threadStatsBuckets; i++) {
+        if (s.periodHistogram[i] == 0 && s.durationHistogram[i] == 0) continue;
+        printf("  %6lu%s %10lu %10lu\n", ns((uint64_t)i * s.bucketWidth),
+               (i == threadStatsBuckets - 1) ? "+" : " ",
+               (unsigned long)s.periodHistogram[i], (unsigned long)s.durationHistogram[i]);
+    }
+}
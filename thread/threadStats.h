@@ -0,0 +1,66 @@
+#ifndef THREADSTATS_H
+#define THREADSTATS_H
+
+#include <cstdint>
+#include <atomic>
+
+constexpr uint32_t threadStatsBuckets = 16;     // histogram buckets, each 1/8 of the nominal period wide
+
+// Timing counters for one thread, all values in cycle counter counts.
+// The period is measured between successive ISR entries, the duration from
+// ISR entry to the end of the module tasks. The last histogram bucket also
+// holds everything beyond two nominal periods.
+struct ThreadStatsData {
+    uint32_t ticks;             // total ticks, not cleared on reset
+    uint32_t nominalPeriod;
+    uint32_t bucketWidth;
+
+    uint32_t durationSamples;
+    uint32_t periodSamples;
+    uint32_t periodMin;
+    uint32_t periodMax;
+    uint64_t periodSum;
+
+    uint32_t durationMin;
+    uint32_t durationMax;
+    uint64_t durationSum;
+
+    uint32_t periodHistogram[threadStatsBuckets];
+    uint32_t durationHistogram[threadStatsBuckets];
+
+    uint32_t totalOverruns;     // not cleared on reset
+    uint32_t overruns;          // ticks that ran longer than the nominal period
+    uint32_t lateTicks;         // ticks that started more than half a period late
+    uint32_t missedTicks;       // whole periods with no tick at all
+    uint32_t worstOverrun;      // longest overrunning duration
+    uint32_t worstOverrunTick;  // tick number it happened on
+};
+
+class ThreadStats {
+private:
+    ThreadStatsData data;
+    uint32_t lastEntry;
+    bool hasLastEntry;
+
+    // sequence count is odd while the ISR is writing, the main loop retries
+    // its copy if the count moved underneath it
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<bool> resetPending{false};
+
+    void clear();
+
+public:
+    ThreadStats();
+
+    void configure(uint32_t nominalPeriod);
+    bool record(uint32_t entry, uint32_t exit);     // called from the ISR, returns true on an overrun
+
+    void requestReset() { resetPending.store(true, std::memory_order_release); }
+    void getSnapshot(ThreadStatsData& snapshot) const;
+    uint32_t getTicks() const { return data.ticks; }
+    uint32_t getTotalOverruns() const { return data.totalOverruns; }
+
+    static void print(const char* name, const ThreadStatsData& snapshot, uint32_t counterFreq);
+};
+
+#endif // THREADSTATS_H
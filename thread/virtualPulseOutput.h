@@ -0,0 +1,34 @@
+#ifndef VIRTUALPULSEOUTPUT_H
+#define VIRTUALPULSEOUTPUT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "pulseOutput.h"
+#include "virtualTimer.h"
+
+// A PulseOutput with no hardware behind it, for running the core off target.
+// The rising edge of every scheduled pulse is recorded in virtual time (ns) so
+// the step timing can be checked against the commanded frequency.
+
+class VirtualPulseOutput : public PulseOutput {
+private:
+    uint32_t clockFrequency;
+    std::vector<uint64_t> edges;
+
+public:
+    VirtualPulseOutput(uint32_t _clockFrequency) : clockFrequency(_clockFrequency) {}
+
+    uint32_t getClockFrequency() const override { return clockFrequency; }
+
+    void schedulePulse(uint32_t delay, uint32_t width) override
+    {
+        (void)width;
+        edges.push_back(VirtualTimer::getTime() + (uint64_t)delay * 1000000000ULL / clockFrequency);
+    }
+
+    const std::vector<uint64_t>& getEdges() const { return edges; }
+    void clearEdges() { edges.clear(); }
+};
+
+#endif // VIRTUALPULSEOUTPUT_H
@@ -0,0 +1,93 @@
+#include <algorithm>
+
+#include "virtualTimer.h"
+#include "pruThread.h"
+#include "../interrupt/staticInterrupt.h"
+
+std::vector<VirtualTimer*> VirtualTimer::timers;
+uint64_t VirtualTimer::now = 0;
+
+// The simulated vector table, one TimerIrq per timer IRQ
+template <uint32_t... Irq>
+struct VirtualVectors {
+    static constexpr void (*handlers[])() = { &TimerIrq<Irq, VirtualTimer>::handle... };
+
+    static void bind(uint32_t irq, VirtualTimer* timer)
+    {
+        ((Irq == irq ? TimerIrq<Irq, VirtualTimer>::bind(timer) : (void)0), ...);
+    }
+};
+typedef VirtualVectors<0, 1, 2, 3, 4, 5, 6, 7> Vectors;
+static_assert(sizeof(Vectors::handlers) / sizeof(Vectors::handlers[0]) == VirtualTimer::maxTimers, "one vector per timer IRQ");
+
+VirtualTimer::VirtualTimer(uint32_t freq)
+{
+    frequency = freq;
+
+    // the first free IRQ
+    while (irq < maxTimers && std::any_of(timers.begin(), timers.end(), [this](VirtualTimer* t) { return t->irq == irq; })) irq++;
+    if (irq < maxTimers) Vectors::bind(irq, this);
+    timers.push_back(this);
+}
+
+VirtualTimer::~VirtualTimer()
+{
+    if (irq < maxTimers) Vectors::bind(irq, nullptr);
+    timers.erase(std::remove(timers.begin(), timers.end(), this), timers.end());
+}
+
+void VirtualTimer::configTimer()
+{
+    periodNs = frequency ? 1000000000ULL / frequency : 0;
+}
+
+void VirtualTimer::startTimer()
+{
+    nextTickNs = now + periodNs;
+    timerRunning = periodNs > 0;
+}
+
+void VirtualTimer::stopTimer()
+{
+    timerRunning = false;
+}
+
+void VirtualTimer::timerTick()
+{
+    tickCount++;
+    if (timerOwnerPtr) timerOwnerPtr->update();
+}
+
+// Called from within the tick, as on hardware the new period starts from the
+// current tick so nothing is lost or repeated
+void VirtualTimer::changeFrequency(uint32_t freq)
+{
+    frequency = freq;
+    configTimer();
+    nextTickNs = now + periodNs;
+}
+
+uint64_t VirtualTimer::run(uint64_t durationNs)
+{
+    uint64_t end = now + durationNs;
+    uint64_t fired = 0;
+
+    while (true) {
+        VirtualTimer* due = nullptr;
+        for (VirtualTimer* timer : timers) {
+            if (timer->timerRunning && timer->nextTickNs <= end && (!due || timer->nextTickNs < due->nextTickNs)) {
+                due = timer;
+            }
+        }
+        if (!due) break;
+
+        now = due->nextTickNs;
+        due->nextTickNs += due->periodNs;
+        if (due->irq < maxTimers) Vectors::handlers[due->irq]();     // the timer's IRQ handler
+        else due->timerTick();                                      // more timers than IRQs
+        fired++;
+    }
+
+    now = end;
+    return fired;
+}
@@ -0,0 +1,46 @@
+#ifndef VIRTUALTIMER_H
+#define VIRTUALTIMER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "pruTimer.h"
+
+// A pruTimer with no hardware behind it, for running the realtime core off target.
+// Virtual time only moves when VirtualTimer::run() is called, which fires every
+// running timer's ticks in time order as fast as the host allows. sim/ builds
+// the core as a Linux program on VirtualTimers with a simulated remora-hal.
+//
+// Each timer takes a simulated IRQ number and its ticks are dispatched from a
+// vector table of TimerIrq handlers, the path a platform timer takes.
+
+class VirtualTimer final : public pruTimer {
+public:
+    static constexpr uint32_t maxTimers = 8;    // simulated timer IRQs
+
+private:
+    static std::vector<VirtualTimer*> timers;
+    static uint64_t now;                // virtual time (ns)
+
+    uint32_t irq = 0;                   // simulated IRQ number, the vector table entry
+    uint64_t periodNs = 0;
+    uint64_t nextTickNs = 0;
+    uint64_t tickCount = 0;
+
+public:
+    VirtualTimer(uint32_t freq);
+    ~VirtualTimer() override;
+
+    void configTimer() override;
+    void startTimer() override;
+    void stopTimer() override;
+    void timerTick() override;
+    void changeFrequency(uint32_t freq) override;
+
+    uint64_t getTickCount() const { return tickCount; }
+
+    static uint64_t run(uint64_t durationNs);     // returns the number of ticks fired
+    static uint64_t getTime() { return now; }
+};
+
+#endif // VIRTUALTIMER_H